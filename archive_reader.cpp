@@ -0,0 +1,101 @@
+/*
+ * Auto-added header
+ * File: archive_reader.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <ar.h>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "archive_reader.h"
+#include "convenient.h"
+#include "logger.h"
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::ArchiveReader::ArchiveReader(int fd, ParseMode mode)
+ : fd(fd), mode(mode)
+{
+}
+//------------------------------------------------------------------------------------------------------------------------------
+// returns false on clean end of file before the first byte when allow_eof is set, throws on short reads
+bool ElfMan::ArchiveReader::read_exact(void* buffer, size_t size, bool allow_eof)
+{
+	uint8_t* ptr = (uint8_t*)buffer;
+	size_t done = 0;
+	if (size && lookahead >= 0) {
+		ptr[done++] = (uint8_t)lookahead;
+		lookahead = -1;
+	}
+	while (done < size) {
+		ssize_t res = ::read(fd, ptr + done, size - done);
+		if (res < 0 && errno == EINTR)
+			continue;
+		if (res < 0) {
+			LOG_ERROR("archive read failed: %s", strerror(errno));
+			throw std::runtime_error("Archive read failed");
+		}
+		if (res == 0) {
+			if (allow_eof && done == 0)
+				return false;
+			LOG_ERROR("unexpected end of archive, %ld of %ld bytes read", done, size);
+			throw malformed_object("Truncated archive");
+		}
+		done += res;
+	}
+	return true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<ElfMan::ArchiveObjectFile> ElfMan::ArchiveReader::next()
+{
+	if (!started) {
+		char magic[SARMAG];
+		if (!read_exact(magic, SARMAG, true) || memcmp(magic, ARMAG, SARMAG))
+			throw std::runtime_error("Not a valid ar archive");
+		started = true;
+	}
+	struct ar_hdr header;
+	if (!read_exact(&header, sizeof(header), true))
+		return nullptr;
+	if (Utils::Convenient::trim(std::string(header.ar_fmag, sizeof(header.ar_fmag))) != "`\n") {
+		throw std::runtime_error("Invalid file header magic in ar header");
+	}
+	size_t filesize = Utils::Convenient::parse_decimal(Utils::Convenient::trim(std::string(header.ar_size, sizeof(header.ar_size))));
+	std::string rawName = Utils::Convenient::trim(std::string(header.ar_name, sizeof(header.ar_name)));
+	LOG_DEBUG("streaming object file %s, size %ld\n", rawName.c_str(), filesize);
+	// member owns its buffer, parsed sections borrow from it
+	auto buffer = std::make_shared<std::vector<uint8_t>>(filesize);
+	read_exact(buffer->data(), filesize, false);
+	// GNU ar pads odd sized members with a newline
+	if (filesize % 2) {
+		uint8_t pad;
+		if (read_exact(&pad, 1, true) && pad != '\n')
+			lookahead = pad;
+	}
+	std::string filename = rawName;
+	if (rawName == ElfMan::ArchiveObjectFile::name_table_name)
+		nameTable.assign((const char*)buffer->data(), filesize);
+	else if (rawName != ElfMan::ArchiveObjectFile::symbol_table_name)
+		filename = ElfMan::ArchiveObjectFile::member_name(rawName, nameTable);
+	bool special = rawName == ElfMan::ArchiveObjectFile::symbol_table_name || rawName == ElfMan::ArchiveObjectFile::name_table_name;
+	std::shared_ptr<const std::vector<uint8_t>> image = buffer;
+	if (mode == ParseMode::LAZY && !special)
+		return std::make_shared<ElfMan::UnparsedMember>(image->data(), filesize, header, filename, image);
+	return ElfMan::ArchiveObjectFile::from_bytes(image->data(), filesize, header, filename, image);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::ArchiveReader::for_each(MemberFunc func)
+{
+	size_t count = 0;
+	while (auto member = next()) {
+		count++;
+		// member goes out of scope right after the callback unless the callback kept it
+		if (!func(std::move(member)))
+			break;
+	}
+	return count;
+}
+//------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,52 @@
+/*
+ * Auto-added header
+ * File: archive_reader.h
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#ifndef ELFMAN_ARCHIVE_READER_H
+#define ELFMAN_ARCHIVE_READER_H
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "object_file.h"
+#include "static_library.h"
+//------------------------------------------------------------------------------------------------------------------------------
+namespace ElfMan
+{
+//------------------------------------------------------------------------------------------------------------------------------
+// Forward-only archive reader for files, pipes and stdin.
+// Only one member is held in memory at a time: every member gets its own buffer, which its parsed
+// object borrows from, so it's freed as soon as the caller drops the member.
+// Long filename table is kept for the whole pass, the symbol table is handed out like any other member.
+class ArchiveReader {
+public:
+    // fd is not owned and is read sequentially from its current position
+    // in LAZY mode members are handed out UNPARSED, PARALLEL is treated as EAGER
+    explicit ArchiveReader(int fd, ParseMode mode = ParseMode::EAGER);
+
+    // next member in archive order, nullptr at the end of archive
+    std::shared_ptr<ArchiveObjectFile> next();
+    // calls func for every remaining member, stops early when func returns false.
+    // returns number of members processed
+    using MemberFunc = std::function<bool(std::shared_ptr<ArchiveObjectFile>)>;
+    size_t for_each(MemberFunc func);
+private:
+    bool read_exact(void* buffer, size_t size, bool allow_eof);
+
+    int fd;
+    ParseMode mode;
+    bool started = false;
+    int lookahead = -1; // byte read past an odd sized member that turned out not to be padding
+    std::string nameTable; // GNU string table for long filenames
+};
+//------------------------------------------------------------------------------------------------------------------------------
+} //namespace ElfMan
+//------------------------------------------------------------------------------------------------------------------------------
+#endif/*ELFMAN_ARCHIVE_READER_H*/
@@ -0,0 +1,195 @@
+/*
+ * Auto-added header
+ * File: archive_writer.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <ar.h>
+#include <elf.h>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "archive_writer.h"
+#include "static_library.h"
+#include "logger.h"
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::ArchiveWriter::ArchiveWriter(int fd, size_t map_headroom)
+ : fd(fd), output(fd), map_headroom(map_headroom)
+{
+	start = lseek(fd, 0, SEEK_CUR);
+	seekable = start >= 0;
+	write_all((const uint8_t*)ARMAG, SARMAG);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::ArchiveWriter::~ArchiveWriter()
+{
+	try {
+		finish();
+	}
+	catch (const std::exception& e) {
+		LOG_ERROR("archive symbol map not written: %s", e.what());
+	}
+	if (spool)
+		fclose(spool);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ArchiveWriter::write_all(const uint8_t* buffer, size_t size)
+{
+	write_fd(fd, buffer, size);
+	total += size;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ArchiveWriter::write_fd(int fd, const uint8_t* buffer, size_t size)
+{
+	size_t done = 0;
+	while (done < size) {
+		ssize_t res = ::write(fd, buffer + done, size - done);
+		if (res < 0 && errno == EINTR)
+			continue;
+		if (res <= 0) {
+			LOG_ERROR("archive write failed: %s", strerror(errno));
+			throw std::runtime_error("Archive write failed");
+		}
+		done += res;
+	}
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ArchiveWriter::add(ArchiveObjectFile& member)
+{
+	if (ArchiveObjectFileType::STRING_TABLE == member.type && member.filename() == ArchiveObjectFile::symbol_table_name) {
+		reserve_symbol_map(member);
+		return;
+	}
+	size_t offset = total;
+	size_t size = member.serialized_size();
+	member.size(size);
+	// GNU ar keeps members 2-byte aligned with a newline pad after odd sized ones
+	size_t padded = size + (size % 2);
+	scratch.resize(sizeof(ar_hdr) + padded);
+	Memory::OutputMemoryStream stream(scratch.data(), scratch.size());
+	stream.write(member.header);
+	member.serialize_into(stream);
+	if (padded != size)
+		stream.fill(1, '\n');
+	LOG_DEBUG("writing member %s, size %ld", member.filename().c_str(), size);
+	write_all(scratch.data(), scratch.size());
+	if (map_reserved)
+		collect_symbols(member, offset);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ArchiveWriter::reserve_symbol_map(ArchiveObjectFile& map)
+{
+	// linkers only look for the map in the first member, offsets of anything before it would be lost anyway
+	if (total != SARMAG || map_reserved) {
+		LOG_ERROR("archive symbol map is not the first member, dropped");
+		return;
+	}
+	if (!seekable) {
+		// the map can only be filled in once every member is written, which a pipe won't let us do
+		spool = tmpfile();
+		if (!spool) {
+			LOG_ERROR("can't create a temporary file for the archive: %s", strerror(errno));
+			throw std::runtime_error("Archive spool failed");
+		}
+		LOG_DEBUG("output can't seek, archive is spooled until finish()");
+		fd = fileno(spool);
+		// magic is already out, the spool starts right after it
+		start = -(off_t)SARMAG;
+	}
+	// payload is zeroed (an empty map) until finish() fills it in
+	map_offset = total;
+	map_size = map.serialized_size() + map_headroom;
+	map_size += map_size % 2;
+	map.size(map_size);
+	scratch.assign(sizeof(ar_hdr) + map_size, 0);
+	Memory::OutputMemoryStream stream(scratch.data(), scratch.size());
+	stream.write(map.header);
+	LOG_DEBUG("reserved %ld byte(s) for archive symbol map", map_size);
+	write_all(scratch.data(), scratch.size());
+	map_reserved = true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ArchiveWriter::collect_symbols(ArchiveObjectFile& member, size_t offset)
+{
+	std::shared_ptr<ArchiveObjectFile> parsed;
+	ObjectFile* object = nullptr;
+	if (ArchiveObjectFileType::ELF_OBJECT == member.type)
+		object = static_cast<ObjectFile*>(&member);
+	else if (ArchiveObjectFileType::UNPARSED == member.type) {
+		// only ELF members define symbols, anything else can't be parsed
+		auto& unparsed = static_cast<UnparsedMember&>(member);
+		const uint8_t* bytes = unparsed.bytes();
+		if (unparsed.serialized_size() < SELFMAG || memcmp(bytes, ELFMAG, SELFMAG))
+			return;
+		parsed = unparsed.parse();
+		if (ArchiveObjectFileType::ELF_OBJECT == parsed->type)
+			object = static_cast<ObjectFile*>(parsed.get());
+	}
+	if (!object)
+		return;
+	std::vector<std::string> names = object->defined_global_symbols();
+	if (names.empty())
+		return;
+	map_names.push_back(std::move(names));
+	map_members.push_back(offset);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ArchiveWriter::finish()
+{
+	if (finished)
+		return;
+	finished = true;
+	if (!map_reserved)
+		return;
+	std::vector<uint8_t> map = StaticLibrary::build_symbol_map(map_names, map_members);
+	if (map.size() > map_size) {
+		LOG_ERROR("archive symbol map needs %ld byte(s), only %ld were reserved", map.size(), map_size);
+		throw std::runtime_error("Archive symbol map doesn't fit");
+	}
+	// a smaller map is padded with zeros behind the last name
+	map.resize(map_size, 0);
+	off_t position = start + map_offset + sizeof(ar_hdr);
+	size_t done = 0;
+	while (done < map.size()) {
+		ssize_t res = ::pwrite(fd, map.data() + done, map.size() - done, position + done);
+		if (res < 0 && errno == EINTR)
+			continue;
+		if (res <= 0) {
+			LOG_ERROR("archive symbol map write failed: %s", strerror(errno));
+			throw std::runtime_error("Archive write failed");
+		}
+		done += res;
+	}
+	LOG_DEBUG("archive symbol map written, %ld member(s) define symbols", map_members.size());
+	if (spool)
+		copy_spool();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ArchiveWriter::copy_spool()
+{
+	if (lseek(fd, 0, SEEK_SET) < 0) {
+		LOG_ERROR("can't rewind archive spool: %s", strerror(errno));
+		throw std::runtime_error("Archive spool failed");
+	}
+	scratch.resize(1 << 16);
+	for (;;) {
+		ssize_t res = ::read(fd, scratch.data(), scratch.size());
+		if (res < 0 && errno == EINTR)
+			continue;
+		if (res < 0) {
+			LOG_ERROR("archive spool read failed: %s", strerror(errno));
+			throw std::runtime_error("Archive spool failed");
+		}
+		if (res == 0)
+			break;
+		write_fd(output, scratch.data(), res);
+	}
+	fclose(spool);
+	spool = nullptr;
+	fd = output;
+}
+//------------------------------------------------------------------------------------------------------------------------------
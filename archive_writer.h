@@ -0,0 +1,74 @@
+/*
+ * Auto-added header
+ * File: archive_writer.h
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#ifndef ELFMAN_ARCHIVE_WRITER_H
+#define ELFMAN_ARCHIVE_WRITER_H
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <sys/types.h>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "object_file.h"
+//------------------------------------------------------------------------------------------------------------------------------
+namespace ElfMan
+{
+//------------------------------------------------------------------------------------------------------------------------------
+// Sequential archive writer for files, pipes and stdout.
+// Members are written in the order they are added, every member's ar_size is taken from its serialized_size()
+// before anything is written. Memory use is bounded by the largest member. Headers are written as they are,
+// so the long filename table has to be added before members referring to it, like in the source archive.
+// GNU symbol map ("/" member) is never copied, it would go stale as soon as some member changes. On seekable
+// outputs its slot is reserved with the size of the given one and filled by finish() from the members written
+// after it (unparsed members get parsed for that). Pipes can't be patched, so there everything from the map on
+// goes to a temporary file first and reaches the pipe only in finish(). Archives without a map are streamed
+// straight through either way
+class ArchiveWriter {
+public:
+    // fd is not owned, archive magic is written right away.
+    // map_headroom is reserved on top of the given symbol map's size, for edits making names longer
+    explicit ArchiveWriter(int fd, size_t map_headroom = 0);
+    // finishes the archive if finish() wasn't called, errors are only logged then
+    ~ArchiveWriter();
+
+    void add(ArchiveObjectFile& member);
+    void add(const std::shared_ptr<ArchiveObjectFile>& member) { add(*member); }
+    // writes the symbol map into its reserved slot, and copies the spooled archive out when fd is a pipe.
+    // Throws if the map outgrew the slot
+    void finish();
+    // bytes written so far, magic included
+    size_t written() const { return total; }
+private:
+    void write_all(const uint8_t* buffer, size_t size);
+    static void write_fd(int fd, const uint8_t* buffer, size_t size);
+    void reserve_symbol_map(ArchiveObjectFile& map);
+    void collect_symbols(ArchiveObjectFile& member, size_t offset);
+    void copy_spool();
+
+    int fd; // where members go, the spool file while spooling
+    int output; // fd given to us
+    bool seekable;
+    off_t start = 0; // fd position of the archive magic
+    FILE* spool = nullptr;
+    size_t total = 0;
+    std::vector<uint8_t> scratch; // reused for every member
+    // reserved symbol map slot: header offset and payload size, names defined by every member written after it
+    bool map_reserved = false;
+    size_t map_offset = 0;
+    size_t map_size = 0;
+    size_t map_headroom;
+    std::vector<std::vector<std::string>> map_names;
+    std::vector<size_t> map_members;
+    bool finished = false;
+};
+//------------------------------------------------------------------------------------------------------------------------------
+} //namespace ElfMan
+//------------------------------------------------------------------------------------------------------------------------------
+#endif/*ELFMAN_ARCHIVE_WRITER_H*/
@@ -0,0 +1,136 @@
+/*
+ * Auto-added header
+ * File: edit_transaction.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <algorithm>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "edit_transaction.h"
+#include "logger.h"
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::EditTransaction::EditTransaction(StaticLibrary& lib)
+    : library(&lib)
+{
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::EditTransaction::EditTransaction(ObjectFile& obj)
+    : object(&obj)
+{
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::EditTransaction& ElfMan::EditTransaction::rename_symbol(const std::string& old_name, const std::string& new_name,
+                                                                const std::string& member)
+{
+    edits.push_back(Edit{EditType::RENAME, member, old_name, new_name, false});
+    return *this;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::EditTransaction& ElfMan::EditTransaction::set_global(const std::string& name, const std::string& member)
+{
+    edits.push_back(Edit{EditType::SET_GLOBAL, member, name, std::string(), false});
+    return *this;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::EditTransaction& ElfMan::EditTransaction::insert_undefined_global_function(const std::string& name, bool thumb,
+                                                                                   const std::string& member)
+{
+    edits.push_back(Edit{EditType::INSERT_UNDEFINED, member, name, std::string(), thumb});
+    return *this;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::EditTransaction& ElfMan::EditTransaction::move_relocations(const std::string& src_name, const std::string& dest_name,
+                                                                   const std::string& member)
+{
+    edits.push_back(Edit{EditType::MOVE_RELOCATIONS, member, src_name, dest_name, false});
+    return *this;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::vector<ElfMan::ObjectFile*> ElfMan::EditTransaction::targets(const Edit& edit, bool any_member)
+{
+    std::vector<ObjectFile*> result;
+    if (object) {
+        result.push_back(object);
+        return result;
+    }
+    if (!edit.member.empty()) {
+        // short ar names keep their terminating '/' (long ones don't), both spellings are accepted for them
+        std::shared_ptr<ObjectFile> objfile = library->get_object(edit.member);
+        if (!objfile && edit.member.back() != '/')
+            objfile = library->get_object(edit.member + "/");
+        if (objfile)
+            result.push_back(objfile.get());
+        return result;
+    }
+    if (!any_member)
+        return result;
+    // the index follows renames applied earlier in this commit
+    if (auto entries = library->symbol_index().entries(edit.name))
+        for (auto& entry : *entries)
+            result.push_back(entry.symbol.object());
+    return result;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+bool ElfMan::EditTransaction::apply(const Edit& edit, ObjectFile& objfile)
+{
+    switch (edit.type) {
+    case EditType::RENAME:
+        return (bool)objfile.rename_symbol(edit.name, edit.target);
+    case EditType::SET_GLOBAL: {
+        Symbol symbol = objfile.find_symbol(edit.name);
+        if (!symbol)
+            return false;
+        // binding change is only recorded, the symbol table is reordered once at the end
+        return symbol.set_global();
+    }
+    case EditType::INSERT_UNDEFINED:
+        return (bool)objfile.append_undefined_global_function(edit.name, edit.thumb);
+    case EditType::MOVE_RELOCATIONS: {
+        Symbol src = objfile.find_symbol(edit.name);
+        Symbol dest = objfile.find_symbol(edit.target);
+        if (!src || !dest)
+            return false;
+        objfile.move_relocations(src.index(), dest.index());
+        return true;
+    }
+    }
+    return false;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+bool ElfMan::EditTransaction::commit()
+{
+    bool result = true;
+    std::vector<ObjectFile*> touched;
+    for (auto& edit : edits) {
+        // inserts and relocation moves are object local, they need an explicit member
+        bool any_member = edit.type == EditType::RENAME || edit.type == EditType::SET_GLOBAL;
+        std::vector<ObjectFile*> objects = targets(edit, any_member);
+        if (objects.empty()) {
+            LOG_ERROR("no object to apply edit for symbol %s to (member '%s')", edit.name.c_str(), edit.member.c_str());
+            result = false;
+            continue;
+        }
+        for (ObjectFile* objfile : objects) {
+            if (!apply(edit, *objfile)) {
+                LOG_ERROR("failed to apply edit for symbol %s to %s", edit.name.c_str(), objfile->filename().c_str());
+                result = false;
+                continue;
+            }
+            touched.push_back(objfile);
+        }
+    }
+    // one reorder per touched object, covering every binding change above
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (ObjectFile* objfile : touched) {
+        objfile->reorder_changed_symbols();
+        if (compact)
+            objfile->compact_symbol_strtab();
+    }
+    LOG_DEBUG("committed %ld edit(s) over %ld object(s)", edits.size(), touched.size());
+    edits.clear();
+    return result;
+}
+//------------------------------------------------------------------------------------------------------------------------------
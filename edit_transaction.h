@@ -0,0 +1,70 @@
+/*
+ * Auto-added header
+ * File: edit_transaction.h
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#ifndef ELFMAN_EDIT_TRANSACTION_H
+#define ELFMAN_EDIT_TRANSACTION_H
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "object_file.h"
+#include "static_library.h"
+//------------------------------------------------------------------------------------------------------------------------------
+namespace ElfMan
+{
+//------------------------------------------------------------------------------------------------------------------------------
+// Batch of symbol edits over a library or a single object.
+// Edits are only queued until commit(), which applies them in queue order without per edit fixups,
+// then reorders every touched symbol table once. Sizes and offsets are fixed up by the single layout pass
+// of the following serialize().
+// Member names select the object an edit applies to, an empty member means every member carrying the symbol
+// (for a transaction over a single object it's ignored)
+class EditTransaction {
+public:
+    explicit EditTransaction(StaticLibrary& library);
+    explicit EditTransaction(ObjectFile& object);
+
+    EditTransaction& rename_symbol(const std::string& old_name, const std::string& new_name, const std::string& member = "");
+    EditTransaction& set_global(const std::string& name, const std::string& member = "");
+    EditTransaction& insert_undefined_global_function(const std::string& name, bool thumb, const std::string& member);
+    EditTransaction& move_relocations(const std::string& src_name, const std::string& dest_name, const std::string& member);
+    size_t size() const { return edits.size(); }
+    // also drop strings left behind by renames from the string table of every touched object on commit
+    EditTransaction& compact_strings(bool enable = true) { compact = enable; return *this; }
+    // applies queued edits and empties the queue. Edits which can't be applied (unknown member or symbol)
+    // are reported and skipped, the rest is still applied. Returns false if anything was skipped
+    bool commit();
+private:
+    enum class EditType {
+        RENAME,
+        SET_GLOBAL,
+        INSERT_UNDEFINED,
+        MOVE_RELOCATIONS,
+    };
+    struct Edit {
+        EditType type;
+        std::string member;
+        std::string name;
+        std::string target; // new name or relocation target
+        bool thumb = false;
+    };
+    // objects an edit applies to, empty if there are none
+    std::vector<ObjectFile*> targets(const Edit& edit, bool any_member);
+    bool apply(const Edit& edit, ObjectFile& object);
+
+    StaticLibrary* library = nullptr;
+    ObjectFile* object = nullptr;
+    std::vector<Edit> edits;
+    bool compact = false;
+};
+//------------------------------------------------------------------------------------------------------------------------------
+} //namespace ElfMan
+//------------------------------------------------------------------------------------------------------------------------------
+#endif /*ELFMAN_EDIT_TRANSACTION_H*/
@@ -0,0 +1,56 @@
+/*
+ * Auto-added header
+ * File: mapped_file.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "mapped_file.h"
+#include "logger.h"
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::MappedFile::MappedFile(const std::string& path)
+ : _path(path)
+{
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		LOG_ERROR("failed to open %s: %s", path.c_str(), strerror(errno));
+		throw std::runtime_error("Failed to open file");
+	}
+	struct stat st;
+	if (fstat(fd, &st) < 0) {
+		LOG_ERROR("failed to stat %s: %s", path.c_str(), strerror(errno));
+		::close(fd);
+		throw std::runtime_error("Failed to stat file");
+	}
+	_size = st.st_size;
+	// mmap refuses zero length mappings, an empty file is just an empty image
+	if (_size) {
+		void* addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED) {
+			LOG_ERROR("failed to map %s: %s", path.c_str(), strerror(errno));
+			::close(fd);
+			throw std::runtime_error("Failed to map file");
+		}
+		// we walk archives front to back
+		madvise(addr, _size, MADV_SEQUENTIAL);
+		_data = (const uint8_t*)addr;
+	}
+	// the mapping stays valid after the descriptor is closed
+	::close(fd);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::MappedFile::~MappedFile()
+{
+	if (_data)
+		munmap((void*)_data, _size);
+}
+//------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,39 @@
+/*
+ * Auto-added header
+ * File: mapped_file.h
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#ifndef ELFMAN_MAPPED_FILE_H
+#define ELFMAN_MAPPED_FILE_H
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdint.h>
+#include <string>
+//------------------------------------------------------------------------------------------------------------------------------
+namespace ElfMan
+{
+//------------------------------------------------------------------------------------------------------------------------------
+// read-only memory mapping of a whole file.
+// parsed objects keep a shared_ptr to the mapping and reference section payloads in it directly,
+// so the mapping must stay alive for as long as anything loaded from it is used
+class MappedFile {
+public:
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* data() const { return _data; }
+	size_t size() const { return _size; }
+	const std::string& path() const { return _path; }
+private:
+	std::string _path;
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+};
+//------------------------------------------------------------------------------------------------------------------------------
+} //namespace ElfMan
+//------------------------------------------------------------------------------------------------------------------------------
+#endif/*ELFMAN_MAPPED_FILE_H*/
@@ -49,6 +49,23 @@ void InputMemoryStream::read(std::vector<uint8_t>& value, size_t count) {
     skip(count);
 }
 //------------------------------------------------------------------------------------------------------------------------------
+std::vector<uint8_t>& CowBuffer::mutable_data() {
+    if (view_) {
+        data_.assign(view_, view_ + view_size_);
+        view_ = nullptr;
+        view_size_ = 0;
+        source_.reset();
+    }
+    return data_;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void CowBuffer::assign(std::vector<uint8_t>&& bytes) {
+    data_ = std::move(bytes);
+    view_ = nullptr;
+    view_size_ = 0;
+    source_.reset();
+}
+//------------------------------------------------------------------------------------------------------------------------------
 } // Memory
 //------------------------------------------------------------------------------------------------------------------------------
 } // ElfMan
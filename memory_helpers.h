@@ -41,6 +41,7 @@
 #include <stdint.h>
 #include <cstring>
 #include <vector>
+#include <memory>
 #include "exceptions.h"
 //------------------------------------------------------------------------------------------------------------------------------
 #ifdef _MSC_VER
@@ -208,6 +209,51 @@ private:
     size_t size_;
 };
 //------------------------------------------------------------------------------------------------------------------------------
+// copy-on-write byte buffer.
+// While an owner of the source image is known the bytes are only referenced, a private copy is made
+// by the first mutable_data() call. Without an owner the bytes are copied right away.
+class CowBuffer {
+public:
+    CowBuffer() = default;
+
+    CowBuffer(const uint8_t* buffer, size_t total_sz, std::shared_ptr<const void> owner) {
+        if (owner && total_sz) {
+            source_ = std::move(owner);
+            view_ = buffer;
+            view_size_ = total_sz;
+        }
+        else {
+            data_.assign(buffer, buffer + total_sz);
+        }
+    }
+
+    const uint8_t* data() const {
+        return view_ ? view_ : data_.data();
+    }
+
+    size_t size() const {
+        return view_ ? view_size_ : data_.size();
+    }
+
+    bool borrowed() const {
+        return view_ != nullptr;
+    }
+
+    const std::shared_ptr<const void>& owner() const {
+        return source_;
+    }
+
+    std::vector<uint8_t>& mutable_data();
+    // replaces the contents, a borrowed view is dropped without being copied
+    void assign(std::vector<uint8_t>&& bytes);
+private:
+    std::vector<uint8_t> data_;
+    // keeps the source image alive while we point into it
+    std::shared_ptr<const void> source_;
+    const uint8_t* view_ = nullptr;
+    size_t view_size_ = 0;
+};
+//------------------------------------------------------------------------------------------------------------------------------
 } // Memory
 //------------------------------------------------------------------------------------------------------------------------------
 } // ElfMan
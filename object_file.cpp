@@ -6,9 +6,13 @@
  * 2025
  */
 //------------------------------------------------------------------------------------------------------------------------------
+#include <cstring>
+#include <string_view>
+//------------------------------------------------------------------------------------------------------------------------------
 #include "memory_helpers.h"
 #include "object_file.h"
 #include "section.h"
+#include "string_table_builder.h"
 #include "logger.h"
 //------------------------------------------------------------------------------------------------------------------------------
 const std::string ElfMan::ArchiveObjectFile::name_table_name = std::string("//");
@@ -27,21 +31,77 @@ std::shared_ptr<ElfMan::ArchiveObjectFile> ElfMan::ArchiveObjectFile::from_bytes
 	const uint8_t* buffer, 
 	uint32_t total_sz, 
 	struct ar_hdr hdr, 
-	std::string fname)
+	std::string fname,
+	std::shared_ptr<const void> source)
 {
 	if (fname == name_table_name || fname == symbol_table_name) {
 		auto it = registry().find(ArchiveObjectFileType::STRING_TABLE);
 	    if (it != registry().end()) {
-	        return (it->second)(buffer, total_sz, hdr, fname);
+	        return (it->second)(buffer, total_sz, hdr, fname, source);
 	    }
 	}
     
     // fallback — binary object
-    return std::make_shared<ElfMan::ObjectFile>(buffer, total_sz, hdr, fname);
+    return std::make_shared<ElfMan::ObjectFile>(buffer, total_sz, hdr, fname, source);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::string ElfMan::ArchiveObjectFile::member_name(const std::string& rawName, const std::string& nameTable)
+{
+	if (!rawName.empty() && rawName[0] == '/' && rawName.size() > 1) {
+		// Long filename reference into string table
+		size_t offsetInTable = std::stoul(rawName.substr(1));
+		if (offsetInTable >= nameTable.size()) {
+			LOG_ERROR("Invalid string table offset %ld\n", offsetInTable);
+			throw std::runtime_error("Invalid string table offset");
+		}
+		size_t endPos = nameTable.find('/', offsetInTable);
+		if (endPos == std::string::npos) {
+			endPos = nameTable.find('\n', offsetInTable);
+		}
+		if (endPos == std::string::npos) {
+			throw std::runtime_error("Unterminated filename in string table");
+		}
+		return nameTable.substr(offsetInTable, endPos - offsetInTable);
+	}
+	// Normal short name
+	// don't change it
+	return rawName;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::vector<uint8_t> ElfMan::ArchiveObjectFile::serialize()
+{
+	std::vector<uint8_t> result(serialized_size());
+	ElfMan::Memory::OutputMemoryStream stream(result.data(), result.size());
+	serialize_into(stream);
+	return result;
 }
 //------------------------------------------------------------------------------------------------------------------------------
-ElfMan::ObjectFile::ObjectFile(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname)
- : ArchiveObjectFile(hdr, fname)
+void ElfMan::ArchiveObjectFile::size(size_t sz)
+{
+	std::string value = std::to_string(sz);
+	// ar_size is a space padded decimal without a terminator
+	memset(header.ar_size, ' ', sizeof(header.ar_size));
+	memcpy(header.ar_size, value.data(), std::min(value.size(), sizeof(header.ar_size)));
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::UnparsedMember::UnparsedMember(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname,
+                                       std::shared_ptr<const void> src)
+ : ArchiveObjectFile(hdr, fname), data(buffer, total_sz, src)
+{
+	type = ArchiveObjectFileType::UNPARSED;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<ElfMan::ArchiveObjectFile> ElfMan::UnparsedMember::parse()
+{
+	LOG_DEBUG("parsing archive member %s on demand", filename().c_str());
+	// when our bytes are borrowed the parsed object borrows from the same image,
+	// otherwise it copies what it needs and our buffer may be dropped afterwards
+	return from_bytes(data.data(), data.size(), header, filename(), data.owner());
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::ObjectFile::ObjectFile(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname,
+                               std::shared_ptr<const void> src)
+ : ArchiveObjectFile(hdr, fname), arena(std::make_shared<std::pmr::monotonic_buffer_resource>(total_sz / 2 + 1024)), source(src)
 {
 	// Validation: sanity-check the provided buffer looks like an ELF object file.
 	// - Ensure we have at least the ELF magic bytes and a minimal header size.
@@ -61,6 +121,8 @@ ElfMan::ObjectFile::ObjectFile(const uint8_t* buffer, uint32_t total_sz, struct
 	    throw std::runtime_error("Truncated ELF header");
 	}
 	type = ArchiveObjectFileType::ELF_OBJECT;
+	if (source)
+		original = Memory::CowBuffer(buffer, total_sz, source);
 	int index = 0;
 	// we only need elf_header_stream to read elf_header
 	ElfMan::Memory::InputMemoryStream elf_header_stream(buffer, total_sz);
@@ -86,81 +148,114 @@ ElfMan::ObjectFile::ObjectFile(const uint8_t* buffer, uint32_t total_sz, struct
     }
     // symbol table section always have a link to symbol string table section
     symbol_strtab_section = std::dynamic_pointer_cast<RawSection>(sections_by_index[symtab_section->link()]);
-    // and section name string table section is assumed to be always the last
-	section_strtab_section = std::dynamic_pointer_cast<RawSection>(sections_by_index[sections_by_index.size()-1]);
-	// relink all relocations
-	for (auto &section_pair : sections) {
-		std::shared_ptr<ElfMan::Section> section = section_pair.second;
-		if(!section->size() || section->type() != SHT_REL)
-			continue;
-		if (auto reltab = std::dynamic_pointer_cast<RelocationSection>(section)) {
-			for (auto& rel : reltab->relocations)
-				rel->parent_ptr = section;
-		}
-		else {
-			throw std::runtime_error("dynamic cast to RelocationSection failed");
-		}
+	// section names are in the table the ELF header points to, with SHN_XINDEX its index is in section 0 link.
+	// Names get rewritten when string tables are merged, so anything but a string table isn't taken for it
+	uint32_t shstrndx = ehdr.e_shstrndx == SHN_XINDEX ? sections_by_index[0]->link() : ehdr.e_shstrndx;
+	if (shstrndx != SHN_UNDEF && shstrndx < sections_by_index.size() && sections_by_index[shstrndx]->type() == SHT_STRTAB)
+		section_strtab_section = std::dynamic_pointer_cast<RawSection>(sections_by_index[shstrndx]);
+	else
+		LOG_ERROR("%s: no section name string table (e_shstrndx %d)", fname.c_str(), ehdr.e_shstrndx);
+	// remember the zero pads between sections, layout() has to know them once offsets change
+	uint32_t end = sizeof(ehdr);
+	for (auto& secpair : sections)
+	{
+		uint32_t align = secpair.second->addralign() > 1 ? secpair.second->addralign() : 1;
+		uint32_t aligned = (end + align - 1) / align * align;
+		if (secpair.first > aligned)
+			secpair.second->leading_gap = secpair.first - aligned;
+		end = std::max(end, secpair.first + secpair.second->size());
 	}
-	// populate symtab section symbol map
+	// populate symtab section name lookup
 	// we couldn't do that until all string table sections were added
-	for (auto &symbol : symtab_section->symbols) {
-		symtab_section->symbols_by_name.insert(std::pair(symbol->name(), symbol));
-	}
+	symtab_section->index_names();
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::vector<uint8_t> ElfMan::ObjectFile::serialize()
+size_t ElfMan::ObjectFile::layout()
 {
-	std::vector<uint8_t> object, section_header;
-	object.resize(sizeof(ehdr));
-	int max_size = 0;
-	for (auto secpair : sections)
+	size_t position = sizeof(ehdr);
+	for (auto& secpair : sections)
 	{
 		std::shared_ptr<ElfMan::Section> sec = secpair.second;
 		if(!sec->size() || sec->type() == SHT_NOBITS)
 			continue;
-		LOG_INFO("processing section %d, size %08X, offset %08X", sec->index, object.size(), sec->offset());
-		std::vector<uint8_t> section_data = sec->serialize();
+		// sections are keyed by their original offset
+		uint32_t original = secpair.first;
 		// move sections if alignment requires that
-		//----------------------------------
-		// additional check for linker generated 0ed pads
-		if (object.size() != sec->offset()) {// && sec->type() != SHT_REL) {
-			LOG_INFO("section %d: adding zero pad from 0x%08X to 0x%08X", sec->index, object.size(), sec->offset());
-			std::vector<uint8_t> padvec(sec->offset() - object.size(), 0);
-			object.insert(object.end(), padvec.begin(), padvec.end());
-		}
-		//----------------------------------
+		size_t aligned = position;
 		if (sec->addralign() > 1)
 		{
-			int padding = object.size() % sec->addralign();
+			size_t padding = aligned % sec->addralign();
 			if (padding)
-			{
-				std::vector<uint8_t> padvec(sec->addralign() - padding, 0);
-				object.insert(object.end(), padvec.begin(), padvec.end());
-			}
-			LOG_DEBUG("section %d: adding alignment pad from 0x%08X to 0x%08lX", sec->index, sec->offset(), object.size());
+				aligned += sec->addralign() - padding;
+		}
+		//----------------------------------
+		// additional check for linker generated 0ed pads
+		if (aligned + sec->leading_gap < original) {
+			// something in front of us got smaller, keep the pad but not the old place,
+			// otherwise whatever was reclaimed turns into zeros and the object never shrinks
+			LOG_DEBUG("section %d: moving down from 0x%08X to 0x%08lX", sec->index, original, aligned + sec->leading_gap);
+			position = aligned + sec->leading_gap;
+		}
+		else if (aligned < original) {
+			LOG_DEBUG("section %d: adding zero pad from 0x%08lX to 0x%08X", sec->index, position, original);
+			position = original;
 		}
-		sec->offset(object.size());
-		object.insert(object.end(), section_data.begin(), section_data.end());
+		else
+			position = aligned;
+		//----------------------------------
+		sec->offset(position);
+		// tables edited without fixups (see append_undefined_global_function) get their sizes here
+		sec->size(sec->serialized_size());
+		position += sec->serialized_size();
 	}
-
 	// padding for section headers table
-	int padding = object.size() % sizeof(uint32_t);
+	size_t padding = position % sizeof(uint32_t);
 	if (padding)
+		position += sizeof(uint32_t) - padding;
+	ehdr.e_shoff = position;
+	return position + sections_by_index.size() * sizeof(Elf32_Shdr);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::ObjectFile::serialized_size()
+{
+	if (!dirty && original.size())
+		return original.size();
+	// string tables are final before the layout depending on their sizes
+	if (merge_strings)
+		merge_string_tables();
+	return layout();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ObjectFile::serialize_into(Memory::OutputMemoryStream& stream)
+{
+	// nothing changed since parsing, original bytes are what we'd produce anyway
+	if (!dirty && original.size()) {
+		stream.write(original.data(), original.size());
+		return;
+	}
+	// layout is cheap and doesn't change once applied, so we never write with stale offsets.
+	// same for merging, already merged tables are left as they are
+	if (merge_strings)
+		merge_string_tables();
+	layout();
+	uint8_t* start = stream.pointer();
+	stream.write(ehdr);
+	for (auto& secpair : sections)
 	{
-		std::vector<uint8_t> padvec(sizeof(uint32_t) - padding, 0);
-		object.insert(object.end(), padvec.begin(), padvec.end());
+		std::shared_ptr<ElfMan::Section> sec = secpair.second;
+		if(!sec->size() || sec->type() == SHT_NOBITS)
+			continue;
+		LOG_INFO("processing section %d, size %08X, offset %08X", sec->index, sec->serialized_size(), sec->offset());
+		stream.fill(sec->offset() - (stream.pointer() - start), 0);
+		sec->serialize_into(stream);
 	}
-	// put in elf header, now that we know section header offset
-	ehdr.e_shoff = object.size();
-	memcpy((uint8_t*)object.data(), (uint8_t*)&ehdr, sizeof(ehdr));
-	for (auto section : sections_by_index)
+	stream.fill(ehdr.e_shoff - (stream.pointer() - start), 0);
+	for (auto& section : sections_by_index)
 	{
 		LOG_DEBUG("writing section header %d data size %08X, addr %08X, alignment %d\n", section->index, section->size(),
 																	section->offset(), section->addralign());
-		section_header.insert(section_header.end(), (char*)section->header(), (char*)section->header() + sizeof(Elf32_Shdr));
+		stream.write(*section->header());
 	}
-	object.insert(object.end(), section_header.begin(), section_header.end());
-	return object;
 }
 //------------------------------------------------------------------------------------------------------------------------------
 void ElfMan::ObjectFile::move_section_offsets(uint32_t addr, int addend)
@@ -180,99 +275,302 @@ void ElfMan::ObjectFile::move_section_offsets(uint32_t addr, int addend)
 //------------------------------------------------------------------------------------------------------------------------------
 // when we changed one or few symbols visibility (local to global or vice versa), we need to reorder them in a symbol table,
 // and after that we need to move all relocations, so that they pointed to correct symbol indexes
-// we take symbols by smart pointer, put them into new vector, change their indexes, but their position in original vector is equal to their old index.
-// so we always know both new and old indexes, and after correction just swap vectors
-void ElfMan::ObjectFile::reorder_symtab_and_relocations()
+// we classify raw symbol entries in one pass and get old index -> new index permutation out of it,
+// relocations are remapped through that permutation, then the table itself is permuted
+std::vector<uint32_t> ElfMan::ObjectFile::reorder_symtab_and_relocations()
 {
-	// reorder symbol table, keeping old indexes inside
-	std::vector<std::shared_ptr<ElfMan::Symbol>> global_symbols, local_symbols, replacement;
-	for (auto symbol : symtab_section->symbols)
-	{
-		if (symbol->bind() == STB_GLOBAL)
-			global_symbols.push_back(symbol);
-		else
-			local_symbols.push_back(symbol);
-	}
-	replacement.insert(replacement.end(), local_symbols.begin(), local_symbols.end());
-	replacement.insert(replacement.end(), global_symbols.begin(), global_symbols.end());
-	// rewrite all symbols symtab indexes
-	for (int i = 0; i < replacement.size(); i++)
+	const auto& entries = symtab_section->entries;
+	uint32_t local_count = 0;
+	for (auto& symhdr : entries)
+		local_count += ELF32_ST_BIND(symhdr.st_info) == STB_LOCAL;
+	// locals keep their relative order, then globals (and weak ones) keep theirs
+	std::vector<uint32_t> permutation(entries.size());
+	uint32_t next_local = 0, next_global = local_count;
+	bool moved = false;
+	for (uint32_t i = 0; i < entries.size(); i++)
 	{
-		replacement[i]->index = i;
+		permutation[i] = ELF32_ST_BIND(entries[i].st_info) == STB_LOCAL ? next_local++ : next_global++;
+		moved |= permutation[i] != i;
 	}
+	// whole table is in order now, pending binding changes are covered
+	symtab_section->clear_rebound();
 	// move symtab section first global symbol index
-	symtab_section->info(local_symbols.size());
+	symtab_section->info(local_count);
+	if (!moved)
+		return permutation;
 	// now relink all relocations to new symtab indexes
+	remap_relocations(permutation);
+	symtab_section->permute(permutation);
+	return permutation;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ObjectFile::remap_relocations(const std::vector<uint32_t>& permutation)
+{
+	const uint32_t* map = permutation.data();
+	uint32_t count = permutation.size();
+	uint32_t symtab_index = symtab_section->index;
 	for (auto section : sections_by_index)
 	{
-		if (section->type() != SHT_REL)
+		if (section->type() != SHT_REL || section->link() != symtab_index)
 			continue;
-		if (auto reltab = std::dynamic_pointer_cast<RelocationSection>(section)) {
-			for (auto& rel : reltab->relocations)
-			{
-				LOG_DEBUG("check relocation %d, offset 0x%08X", rel->index, rel->rhdr.r_offset);
-				// symtab->symbols is not yet reordered,
-				// but all symbol instances in it already have indexes from replacement collection
-				// relocation instances still point to old indexes in symtab
-				// so we take index from relocation instance, dereference it to a symbol instance
-				// then check if its new index matches the old one.
-				// and if not - just rewrite index in relocation instance
-				std::shared_ptr<ElfMan::Symbol> sym = rel->symbol_to_apply();
-				if (!sym)
-				{
-					LOG_ERROR("failed to find symbol for relocation %d\n", rel->index);
-					continue;
-				}
-				if (sym->index != ELF32_R_SYM(rel->rhdr.r_info))
-				{
-					LOG_DEBUG("inconsistent relocation entry for symbol %s, remapping %d to %d\n", 
-																				sym->name().c_str(),
-																				ELF32_R_SYM(rel->rhdr.r_info),
-																				sym->index);
-					rel->rhdr.r_info = ELF32_R_INFO(sym->index,ELF32_R_TYPE(rel->rhdr.r_info));
-				}
-			}
-		}
-		else {
+		auto reltab = std::dynamic_pointer_cast<RelocationSection>(section);
+		if (!reltab)
 			throw std::runtime_error("dynamic cast to RelocationSection failed");
+		// branch free pass over the raw array, every entry is rewritten and changes are only accumulated
+		Elf32_Rel* rel = reltab->entries.data();
+		uint32_t size = reltab->count();
+		uint32_t changed = 0, broken = 0;
+		for (uint32_t i = 0; i < size; i++)
+		{
+			uint32_t info = rel[i].r_info;
+			uint32_t sym = ELF32_R_SYM(info);
+			uint32_t valid = sym < count;
+			uint32_t remapped = valid ? map[sym] : sym;
+			uint32_t updated = ELF32_R_INFO(remapped, ELF32_R_TYPE(info));
+			changed |= info ^ updated;
+			broken += !valid;
+			rel[i].r_info = updated;
 		}
+		if (broken)
+			LOG_ERROR("section %d: %d relocation(s) refer to symbols out of symbol table", reltab->index, broken);
+		if (changed)
+			reltab->mark_dirty();
 	}
-	std::swap(symtab_section->symbols,replacement);
+	// section groups name their signature symbol by index too
+	for (auto section : sections_by_index)
+		if (section->type() == SHT_GROUP && section->link() == symtab_index && section->info() < count)
+			section->info(map[section->info()]);
 }
 //------------------------------------------------------------------------------------------------------------------------------
-// this method rewrite all relocation instancess pointing to a symbol so that they started pointing to another symbol
-void ElfMan::ObjectFile::move_relocations(int src_ind, int dest_ind)
+// Table is assumed to be in order apart from symbols rebound since the last reorder. Symbols which became global
+// are all below sh_info and those which became local are above it. Nothing outside of [first promoted, last demoted]
+// moves, inside the range the order is: remaining locals, demoted, promoted, remaining globals,
+// which is what the full stable partition would produce
+bool ElfMan::ObjectFile::reorder_changed_symbols()
 {
+	const auto& entries = symtab_section->entries;
+	uint32_t boundary = symtab_section->info();
+	if (boundary > entries.size())
+	{
+		LOG_ERROR("symbol table sh_info %d is out of range, reordering whole table", boundary);
+		reorder_symtab_and_relocations();
+		return true;
+	}
+	std::vector<uint32_t> promoted, demoted;
+	for (uint32_t id : symtab_section->rebound_symbols())
+	{
+		uint32_t index = symtab_section->index_of(id);
+		bool local = ELF32_ST_BIND(entries[index].st_info) == STB_LOCAL;
+		if (!local && index < boundary)
+			promoted.push_back(index);
+		else if (local && index >= boundary)
+			demoted.push_back(index);
+	}
+	symtab_section->clear_rebound();
+	if (promoted.empty() && demoted.empty())
+		return false;
+	// a symbol may have been rebound several times
+	std::sort(promoted.begin(), promoted.end());
+	promoted.erase(std::unique(promoted.begin(), promoted.end()), promoted.end());
+	std::sort(demoted.begin(), demoted.end());
+	demoted.erase(std::unique(demoted.begin(), demoted.end()), demoted.end());
+	uint32_t first = promoted.empty() ? boundary : promoted.front();
+	uint32_t last = demoted.empty() ? boundary : demoted.back() + 1;
+	std::vector<uint32_t> moved_to(last - first);
+	uint32_t next = first;
+	auto promoted_it = promoted.begin();
+	for (uint32_t i = first; i < boundary; i++)
+		if (promoted_it != promoted.end() && *promoted_it == i)
+			promoted_it++;
+		else
+			moved_to[i - first] = next++;
+	for (uint32_t index : demoted)
+		moved_to[index - first] = next++;
+	for (uint32_t index : promoted)
+		moved_to[index - first] = next++;
+	auto demoted_it = demoted.begin();
+	for (uint32_t i = boundary; i < last; i++)
+		if (demoted_it != demoted.end() && *demoted_it == i)
+			demoted_it++;
+		else
+			moved_to[i - first] = next++;
+	LOG_DEBUG("reordering symbols %d..%d, %ld promoted, %ld demoted", first, last, promoted.size(), demoted.size());
+	// only relocations referencing the range are touched, they are found through the reverse index
+	index_relocations();
+	for (uint32_t i = first; i < last; i++)
+	{
+		uint32_t to = moved_to[i - first];
+		uint32_t id = symtab_section->id_of(i);
+		if (to == i || id >= relocation_heads.size())
+			continue;
+		for (uint32_t ref = relocation_heads[id]; ref != no_ref; ref = relocation_refs[ref].next)
+		{
+			auto reltab = std::static_pointer_cast<RelocationSection>(sections_by_index[relocation_refs[ref].section]);
+			Elf32_Rel& rhdr = reltab->entries[relocation_refs[ref].position];
+			rhdr.r_info = ELF32_R_INFO(to, ELF32_R_TYPE(rhdr.r_info));
+			reltab->mark_dirty();
+		}
+	}
+	for (auto section : sections_by_index)
+		if (section->type() == SHT_GROUP && section->link() == (uint32_t)symtab_section->index
+		    && section->info() >= first && section->info() < last)
+			section->info(moved_to[section->info() - first]);
+	symtab_section->info(boundary - promoted.size() + demoted.size());
+	symtab_section->permute_range(first, moved_to);
+	return true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ObjectFile::index_relocations()
+{
+	if (relocations_indexed)
+		return;
+	relocation_refs.clear();
+	relocation_heads.assign(symtab_section->count(), no_ref);
+	relocation_tails.assign(symtab_section->count(), no_ref);
+	uint32_t symtab_index = symtab_section->index;
 	for (auto section : sections_by_index)
 	{
-		if (section->type() != SHT_REL)
+		if (section->type() != SHT_REL || section->link() != symtab_index)
 			continue;
-		if (auto relsection = std::dynamic_pointer_cast<ElfMan::RelocationSection>(section)) {
-			for (auto& rel : relsection->relocations) {
-				LOG_DEBUG("check relocation %d, offset 0x%08X\n", rel->index, rel->rhdr.r_offset);
-				std::shared_ptr<ElfMan::Symbol> sym = rel->symbol_to_apply();
-				if (!sym)
-				{
-					LOG_ERROR("failed to find symbol for relocation %d\n", rel->index);
-					continue;
-				}
-				if (sym->index == src_ind)
-				{
-					LOG_INFO("found relocation entry for symbol %d, remapping to symbol %d, section %d,\n", 
-																				src_ind,
-																				dest_ind,
-																				section->index);
-					rel->rhdr.r_info = ELF32_R_INFO(dest_ind,ELF32_R_TYPE(rel->rhdr.r_info));
-				}
+		auto reltab = std::dynamic_pointer_cast<RelocationSection>(section);
+		if (!reltab)
+			throw std::runtime_error("dynamic cast to RelocationSection failed");
+		for (uint32_t i = 0; i < reltab->count(); i++)
+		{
+			uint32_t sym = ELF32_R_SYM(reltab->entries[i].r_info);
+			if (sym >= symtab_section->count())
+			{
+				LOG_ERROR("failed to find symbol for relocation %d\n", i);
+				continue;
 			}
+			uint32_t id = symtab_section->id_of(sym);
+			uint32_t ref = relocation_refs.size();
+			relocation_refs.push_back(RelocationRef{(uint32_t)section->index, i, no_ref});
+			if (relocation_tails[id] == no_ref)
+				relocation_heads[id] = ref;
+			else
+				relocation_refs[relocation_tails[id]].next = ref;
+			relocation_tails[id] = ref;
 		}
-		else {
-			throw std::runtime_error("dynamic cast to RelocationSection failed");
+	}
+	relocations_indexed = true;
+	LOG_DEBUG("relocation index built, %ld reference(s)", relocation_refs.size());
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ObjectFile::relocation_retargeted(const Rel& rel, uint32_t old_index)
+{
+	// nothing to keep current before the index is built, and relocations against other tables aren't in it
+	RelocationSection* reltab = rel.section();
+	uint32_t symtab_index = symtab_section->index;
+	if (!relocations_indexed || reltab->link() != symtab_index)
+		return;
+	uint32_t section = reltab->index;
+	// unlink the reference from the old symbol's list, it's not there if the old index was out of range
+	uint32_t ref = no_ref;
+	if (old_index < symtab_section->count())
+	{
+		uint32_t old_id = symtab_section->id_of(old_index);
+		uint32_t prev = no_ref;
+		if (old_id < relocation_heads.size())
+			for (ref = relocation_heads[old_id]; ref != no_ref; prev = ref, ref = relocation_refs[ref].next)
+				if (relocation_refs[ref].section == section && relocation_refs[ref].position == rel.index())
+					break;
+		if (ref != no_ref)
+		{
+			if (prev == no_ref)
+				relocation_heads[old_id] = relocation_refs[ref].next;
+			else
+				relocation_refs[prev].next = relocation_refs[ref].next;
+			if (relocation_tails[old_id] == ref)
+				relocation_tails[old_id] = prev;
 		}
 	}
+	uint32_t new_index = rel.symbol_index();
+	if (new_index >= symtab_section->count())
+	{
+		LOG_ERROR("failed to find symbol for relocation %d\n", rel.index());
+		return;
+	}
+	if (ref == no_ref)
+	{
+		ref = relocation_refs.size();
+		relocation_refs.push_back(RelocationRef{section, rel.index(), no_ref});
+	}
+	relocation_refs[ref].next = no_ref;
+	// and append it to the new one's, symbols appended after the index was built have no list yet
+	uint32_t id = symtab_section->id_of(new_index);
+	if (relocation_heads.size() <= id)
+	{
+		relocation_heads.resize(id + 1, no_ref);
+		relocation_tails.resize(id + 1, no_ref);
+	}
+	if (relocation_tails[id] == no_ref)
+		relocation_heads[id] = ref;
+	else
+		relocation_refs[relocation_tails[id]].next = ref;
+	relocation_tails[id] = ref;
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::shared_ptr<ElfMan::Symbol> ElfMan::ObjectFile::insert_undefined_global_function(std::string name, bool thumb)
+std::vector<ElfMan::Rel> ElfMan::ObjectFile::relocations_of(const Symbol& symbol)
+{
+	std::vector<Rel> result;
+	if (!symbol || symbol.symtab() != symtab_section.get())
+		return result;
+	index_relocations();
+	uint32_t id = symtab_section->id_of(symbol.index());
+	if (id >= relocation_heads.size())
+		return result;
+	for (uint32_t ref = relocation_heads[id]; ref != no_ref; ref = relocation_refs[ref].next)
+	{
+		auto reltab = std::static_pointer_cast<RelocationSection>(sections_by_index[relocation_refs[ref].section]);
+		result.push_back(reltab->at(relocation_refs[ref].position));
+	}
+	return result;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+// this method rewrite all relocation instancess pointing to a symbol so that they started pointing to another symbol
+void ElfMan::ObjectFile::move_relocations(int src_ind, int dest_ind)
+{
+	if (src_ind < 0 || dest_ind < 0 || (uint32_t)src_ind >= symtab_section->count() || (uint32_t)dest_ind >= symtab_section->count())
+	{
+		LOG_ERROR("can't move relocations from symbol %d to %d, symbol table has %d entries", src_ind, dest_ind, symtab_section->count());
+		return;
+	}
+	if (src_ind == dest_ind)
+		return;
+	index_relocations();
+	uint32_t src = symtab_section->id_of(src_ind);
+	uint32_t dest = symtab_section->id_of(dest_ind);
+	// symbols appended after the index was built have no lists yet
+	size_t ids = std::max(src, dest) + 1;
+	if (relocation_heads.size() < ids)
+	{
+		relocation_heads.resize(ids, no_ref);
+		relocation_tails.resize(ids, no_ref);
+	}
+	if (relocation_heads[src] == no_ref)
+		return;
+	for (uint32_t ref = relocation_heads[src]; ref != no_ref; ref = relocation_refs[ref].next)
+	{
+		auto reltab = std::static_pointer_cast<RelocationSection>(sections_by_index[relocation_refs[ref].section]);
+		Elf32_Rel& rhdr = reltab->entries[relocation_refs[ref].position];
+		LOG_INFO("found relocation entry for symbol %d, remapping to symbol %d, section %d,\n", 
+																	src_ind,
+																	dest_ind,
+																	reltab->index);
+		rhdr.r_info = ELF32_R_INFO(dest_ind,ELF32_R_TYPE(rhdr.r_info));
+		reltab->mark_dirty();
+	}
+	// whole list changes owner
+	if (relocation_tails[dest] == no_ref)
+		relocation_heads[dest] = relocation_heads[src];
+	else
+		relocation_refs[relocation_tails[dest]].next = relocation_heads[src];
+	relocation_tails[dest] = relocation_tails[src];
+	relocation_heads[src] = relocation_tails[src] = no_ref;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::Symbol ElfMan::ObjectFile::append_undefined_global_function(const std::string& name, bool thumb)
 {
 	// insert new symbol
 	Elf32_Sym symhdr;
@@ -281,34 +579,41 @@ std::shared_ptr<ElfMan::Symbol> ElfMan::ObjectFile::insert_undefined_global_func
 	symhdr.st_other = STV_DEFAULT;
 	symhdr.st_shndx = SHN_UNDEF;
 	// insert new symbol name to strtab
-	std::shared_ptr<ElfMan::Symbol> newsym(new ElfMan::Symbol(&symhdr, this));
+	std::vector<uint8_t>& strtab = symbol_strtab_section->mutable_data();
 	// last index offset in strtab will be current strtab size - we write to the end
-	newsym->symhdr.st_name = symbol_strtab_section->data.size();
-	newsym->symhdr.st_info = ELF32_ST_INFO(STB_GLOBAL, STT_FUNC);
-	symbol_strtab_section->data.resize(symbol_strtab_section->data.size()+name.size()+1);
-	std::fill(symbol_strtab_section->data.begin()+newsym->symhdr.st_name, symbol_strtab_section->data.end(),0);
+	symhdr.st_name = strtab.size();
+	symhdr.st_info = ELF32_ST_INFO(STB_GLOBAL, STT_FUNC);
+	strtab.resize(strtab.size()+name.size()+1);
+	std::fill(strtab.begin()+symhdr.st_name, strtab.end(),0);
 	// writning new symbol name into last index offset in strtab
-	memcpy(&symbol_strtab_section->data.data()[newsym->symhdr.st_name], name.data(), name.size());
-	// now saving new symbol index
-	newsym->index = symtab_section->symbols.size();
-	// and saving symbol instance
-	symtab_section->symbols.push_back(newsym);
-	symtab_section->symbols_by_name.insert(std::pair(newsym->name(), newsym));
-	// updating section sizes
+	memcpy(&strtab.data()[symhdr.st_name], name.data(), name.size());
+	// and saving symbol entry, it gets the last index
+	ElfMan::Symbol newsym = symtab_section->append(symhdr);
+	symtab_section->name_added(newsym);
+	LOG_DEBUG("%s %08X %08X %08X %02X %02X %08X\n", newsym.name().c_str(),
+													newsym.header().st_name,
+													newsym.header().st_value,
+													newsym.header().st_size,
+													newsym.header().st_info,
+													newsym.header().st_other,
+													newsym.header().st_shndx);
+	if (symbol_changed)
+		symbol_changed(newsym, std::string());
+	return newsym;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::Symbol ElfMan::ObjectFile::insert_undefined_global_function(std::string name, bool thumb)
+{
 	int old_symtab_size = symtab_section->size();
-	symtab_section->size(old_symtab_size + sizeof(Elf32_Sym));
 	int old_symbol_strtab_size = symbol_strtab_section->size();
+	ElfMan::Symbol newsym = append_undefined_global_function(name, thumb);
+	// updating section sizes
+	symtab_section->size(old_symtab_size + sizeof(Elf32_Sym));
 	symbol_strtab_section->size(old_symbol_strtab_size + name.size()+1);
-	LOG_DEBUG("%s %08X %08X %08X %02X %02X %08X\n", newsym->name().c_str(),
-													newsym->symhdr.st_name,
-													newsym->symhdr.st_value,
-													newsym->symhdr.st_size,
-													newsym->symhdr.st_info,
-													newsym->symhdr.st_other,
-													newsym->symhdr.st_shndx);
 	// symtab section changed size - symbol_strtab_section and section_strtab_section should also change offset
 	symbol_strtab_section->offset(symbol_strtab_section->offset() + sizeof(Elf32_Sym));
-	section_strtab_section->offset(section_strtab_section->offset() + sizeof(Elf32_Sym) + name.size()+1);
+	if (section_strtab_section)
+		section_strtab_section->offset(section_strtab_section->offset() + sizeof(Elf32_Sym) + name.size()+1);
 	// for all rel sections above the symtab and symbol_strtab sections offsets should be modified.
 	for (auto section : sections_by_index)
 	{
@@ -325,48 +630,252 @@ std::shared_ptr<ElfMan::Symbol> ElfMan::ObjectFile::insert_undefined_global_func
 			}
 		}
 	}
-	return std::move(newsym);
+	return newsym;
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::shared_ptr<ElfMan::Symbol> ElfMan::ObjectFile::find_symbol(std::string sym_name)
+ElfMan::Symbol ElfMan::ObjectFile::find_symbol(std::string sym_name)
 {
-	if (auto search = symtab_section->symbols_by_name.find(sym_name); search != symtab_section->symbols_by_name.end())
-		return search->second;
-	else
-		return nullptr;
+	return symtab_section->find(sym_name);
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::shared_ptr<ElfMan::Symbol> ElfMan::ObjectFile::rename_symbol(std::string old_name, std::string new_name)
+ElfMan::Symbol ElfMan::ObjectFile::rename_symbol(std::string old_name, std::string new_name)
 {
-	auto sympair = symtab_section->symbols_by_name.find(old_name);
-	if (sympair == symtab_section->symbols_by_name.end()) {
-		LOG_ERROR("symbol %s not found", old_name.c_str());
-		return nullptr;
-	}
-	std::shared_ptr<ElfMan::Symbol> symbol = sympair->second;
+	ElfMan::Symbol symbol = symtab_section->find(old_name);
 	if (!symbol) {
 		LOG_ERROR("symbol %s not found", old_name.c_str());
-		return nullptr;
+		return Symbol();
+	}
+	if (old_name == new_name)
+		return symbol;
+	uint32_t old_offset = symbol.header().st_name;
+	uint32_t new_offset;
+	if (Symbol existing = symtab_section->find(new_name)) {
+		// same string is already there, share it
+		new_offset = existing.header().st_name;
+		track_name_reference(new_offset);
+	}
+	else if (new_name.size() <= old_name.size() && !name_shared(old_offset, old_name.size())) {
+		// change name for symbol in place
+		uint8_t* ptr = &symbol_strtab_section->mutable_data().data()[old_offset];
+		memset((char *)ptr, 0, old_name.size());
+		memcpy((char *)ptr, new_name.data(), new_name.size());
+		new_offset = old_offset;
+	}
+	else {
+		// appended, old string stays in the table until compact_symbol_strtab(). Sizes are fixed up by layout()
+		std::vector<uint8_t>& strtab = symbol_strtab_section->mutable_data();
+		new_offset = strtab.size();
+		strtab.insert(strtab.end(), new_name.begin(), new_name.end());
+		strtab.push_back(0);
+		track_name_reference(new_offset);
 	}
-	// change name for symbol
-	uint8_t* ptr = &symbol_strtab_section->data.data()[symbol->symhdr.st_name];
-	memset((char *)ptr, 0, old_name.size());
-	strncpy((char *)ptr, new_name.data(), old_name.size());
+	if (new_offset != old_offset) {
+		symbol.header().st_name = new_offset;
+		symtab_section->mark_dirty();
+	}
+	// keep name lookup in sync
+	symtab_section->name_removed(symbol, old_name);
+	symtab_section->name_added(symbol);
+	if (symbol_changed)
+		symbol_changed(symbol, old_name);
 	return symbol;
 }
 //------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ObjectFile::index_name_references()
+{
+	if (name_references_valid)
+		return;
+	name_references.clear();
+	for (auto& symhdr : symtab_section->entries)
+		name_references.push_back(symhdr.st_name);
+	// some toolchains keep section names in the symbol string table too
+	if (section_strtab_section == symbol_strtab_section)
+		for (auto& section : sections_by_index)
+			name_references.push_back(section->name_index());
+	std::sort(name_references.begin(), name_references.end());
+	name_references_valid = true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::ObjectFile::track_name_reference(uint32_t offset)
+{
+	if (!name_references_valid)
+		return;
+	// appended strings are always the last ones, so this is normally a push_back
+	name_references.insert(std::upper_bound(name_references.begin(), name_references.end(), offset), offset);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+bool ElfMan::ObjectFile::name_shared(uint32_t offset, size_t length)
+{
+	// tail of a longer string, assemblers merge those ("counter" inside "my_counter")
+	if (offset && symbol_strtab_section->bytes()[offset - 1])
+		return true;
+	index_name_references();
+	// references which were renamed away are never removed, so this may say shared when it no longer is.
+	// that only costs an append instead of an in-place write
+	auto first = std::lower_bound(name_references.begin(), name_references.end(), offset);
+	auto last = std::lower_bound(first, name_references.end(), offset + length);
+	return last - first > 1;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::ObjectFile::rebuild_string_table(const std::shared_ptr<RawSection>& strtab,
+                                                const std::vector<std::string>* symbol_names)
+{
+	if (!strtab)
+		return 0;
+	const char* names = (const char*)strtab->bytes();
+	size_t names_size = strtab->payload_size();
+	bool symbol_table = strtab == symbol_strtab_section;
+	bool section_names = strtab == section_strtab_section;
+	auto name_at = [&](uint32_t offset) {
+		if (offset >= names_size)
+			return std::string_view();
+		return std::string_view(names + offset, strnlen(names + offset, names_size - offset));
+	};
+	// symbol name, or the one it's being renamed to
+	auto symbol_name = [&](uint32_t i) {
+		if (symbol_names && !(*symbol_names)[i].empty())
+			return std::string_view((*symbol_names)[i]);
+		return name_at(symtab_section->entries[i].st_name);
+	};
+	// names which are still referenced, strings left behind by renames aren't
+	StringTableBuilder builder;
+	if (symbol_table)
+		for (uint32_t i = 0; i < symtab_section->count(); i++)
+			builder.add(symbol_name(i));
+	if (section_names)
+		for (auto& section : sections_by_index)
+			builder.add(name_at(section->name_index()));
+	builder.finalize();
+	// an already merged table is left alone, so is the object. With new names it's applied anyway
+	if (builder.size() >= names_size && !symbol_names)
+		return 0;
+	size_t reclaimed = names_size > builder.size() ? names_size - builder.size() : 0;
+	if (symbol_table) {
+		for (uint32_t i = 0; i < symtab_section->count(); i++)
+			symtab_section->entries[i].st_name = builder.offset_of(symbol_name(i));
+		symtab_section->mark_dirty();
+		name_references_valid = false;
+	}
+	if (section_names)
+		for (auto& section : sections_by_index)
+			section->name_index(builder.offset_of(name_at(section->name_index())));
+	// names above point into the old table, it's only replaced now
+	strtab->assign(std::move(builder.data()));
+	LOG_DEBUG("string table section %d rebuilt, %ld byte(s) reclaimed", strtab->index, reclaimed);
+	return reclaimed;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::ObjectFile::compact_symbol_strtab()
+{
+	return rebuild_string_table(symbol_strtab_section);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::ObjectFile::merge_string_tables()
+{
+	size_t reclaimed = rebuild_string_table(symbol_strtab_section);
+	if (section_strtab_section != symbol_strtab_section)
+		reclaimed += rebuild_string_table(section_strtab_section);
+	return reclaimed;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::ObjectFile::rename_symbols(const SymbolRenameRule& rule)
+{
+	const char* names = (const char*)symbol_strtab_section->bytes();
+	size_t names_size = symbol_strtab_section->payload_size();
+	// new names by symbol table position, empty for symbols which keep theirs
+	std::vector<std::string> new_names(symtab_section->count());
+	std::vector<std::pair<uint32_t, std::string>> old_names;
+	for (uint32_t i = 0; i < symtab_section->count(); i++)
+	{
+		const Elf32_Sym& symhdr = symtab_section->entries[i];
+		if (!symhdr.st_name || symhdr.st_name >= names_size || ELF32_ST_TYPE(symhdr.st_info) == STT_SECTION)
+			continue;
+		std::string_view name(names + symhdr.st_name, strnlen(names + symhdr.st_name, names_size - symhdr.st_name));
+		if (!rule(symhdr, name, new_names[i]) || new_names[i].empty() || new_names[i] == name) {
+			new_names[i].clear();
+			continue;
+		}
+		old_names.emplace_back(i, std::string(name));
+	}
+	if (old_names.empty())
+		return 0;
+	// one string table and one name lookup rebuild for all of them
+	rebuild_string_table(symbol_strtab_section, &new_names);
+	symtab_section->index_names();
+	if (symbol_changed)
+		for (auto& renamed : old_names)
+			symbol_changed(symtab_section->at(renamed.first), renamed.second);
+	LOG_DEBUG("%s: %ld symbol(s) renamed", filename().c_str(), old_names.size());
+	return old_names.size();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::ObjectFile::change_bindings(const BindingChanges& changes)
+{
+	const char* names = (const char*)symbol_strtab_section->bytes();
+	size_t names_size = symbol_strtab_section->payload_size();
+	size_t changed = 0;
+	for (uint32_t i = 0; i < symtab_section->count(); i++)
+	{
+		const Elf32_Sym& symhdr = symtab_section->entries[i];
+		int type = ELF32_ST_TYPE(symhdr.st_info);
+		if (!symhdr.st_name || symhdr.st_name >= names_size || type == STT_SECTION || type == STT_FILE)
+			continue;
+		std::string_view name(names + symhdr.st_name, strnlen(names + symhdr.st_name, names_size - symhdr.st_name));
+		int bind = ELF32_ST_BIND(symhdr.st_info);
+		int new_bind = bind;
+		if (symhdr.st_shndx != SHN_UNDEF && changes.localize.matches(name))
+			new_bind = STB_LOCAL;
+		if (changes.globalize.matches(name))
+			new_bind = STB_GLOBAL;
+		if (new_bind != STB_LOCAL && changes.weaken.matches(name))
+			new_bind = STB_WEAK;
+		bool hide = ELF32_ST_VISIBILITY(symhdr.st_other) != STV_HIDDEN && changes.hide.matches(name);
+		if (new_bind == bind && !hide)
+			continue;
+		// only recorded here, symbols cross the local/global boundary in the single reorder below
+		Symbol symbol = symtab_section->at(i);
+		symbol.set_bind(new_bind);
+		if (hide)
+			symbol.set_visibility(STV_HIDDEN);
+		changed++;
+	}
+	reorder_changed_symbols();
+	if (changed)
+		LOG_DEBUG("%s: binding or visibility of %ld symbol(s) changed", filename().c_str(), changed);
+	return changed;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::vector<std::string> ElfMan::ObjectFile::defined_global_symbols()
+{
+	std::vector<std::string> result;
+	for (uint32_t i = 0; i < symtab_section->count(); i++)
+	{
+		const Elf32_Sym& symhdr = symtab_section->entries[i];
+		int bind = ELF32_ST_BIND(symhdr.st_info);
+		if (bind != STB_GLOBAL && bind != STB_WEAK && bind != STB_GNU_UNIQUE)
+			continue;
+		if (symhdr.st_shndx == SHN_UNDEF)
+			continue;
+		int type = ELF32_ST_TYPE(symhdr.st_info);
+		if (type == STT_SECTION || type == STT_FILE)
+			continue;
+		result.push_back(symtab_section->at(i).name());
+	}
+	return result;
+}
+//------------------------------------------------------------------------------------------------------------------------------
 bool ElfMan::StringTable::registered = []{
     ArchiveObjectFile::register_factory(ElfMan::ArchiveObjectFileType::STRING_TABLE,
-        [](const uint8_t* b, uint32_t sz, struct ar_hdr h, std::string f) {
-            return std::make_shared<ElfMan::StringTable>(b, sz, h, f);
+        [](const uint8_t* b, uint32_t sz, struct ar_hdr h, std::string f, std::shared_ptr<const void> src) {
+            return std::make_shared<ElfMan::StringTable>(b, sz, h, f, src);
         });
     return true;
 }();
 //------------------------------------------------------------------------------------------------------------------------------
 bool ElfMan::ObjectFile::registered = []{
     ArchiveObjectFile::register_factory(ElfMan::ArchiveObjectFileType::ELF_OBJECT,
-        [](const uint8_t* b, uint32_t sz, struct ar_hdr h, std::string f) {
-            return std::make_shared<ElfMan::ObjectFile>(b, sz, h, f);
+        [](const uint8_t* b, uint32_t sz, struct ar_hdr h, std::string f, std::shared_ptr<const void> src) {
+            return std::make_shared<ElfMan::ObjectFile>(b, sz, h, f, src);
         });
     return true;
 }();
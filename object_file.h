@@ -11,11 +11,15 @@
 //------------------------------------------------------------------------------------------------------------------------------
 #include <stdint.h>
 #include <string>
+#include <string_view>
 #include <iterator>
 #include <vector>
 #include <map>
 #include <algorithm>
 #include <memory>
+#include <functional>
+#include <atomic>
+#include <memory_resource>
 #include <elf.h>
 #include <ar.h>
 //------------------------------------------------------------------------------------------------------------------------------
@@ -23,6 +27,7 @@
 #include "symbol.h"
 #include "rel.h"
 #include "symbol_section.h"
+#include "symbol_matcher.h"
 #include "relocation_section.h"
 #include "raw_section.h"
 #include "convenient.h"
@@ -34,6 +39,7 @@ enum ArchiveObjectFileType {
 	UNKNOWN,
 	STRING_TABLE,
 	ELF_OBJECT,
+	UNPARSED,
 };
 //------------------------------------------------------------------------------------------------------------------------------
 class ArchiveObjectFile {
@@ -41,21 +47,40 @@ public:
 	ArchiveObjectFile(struct ar_hdr hdr, std::string fname)
 	: header(hdr),_filename(fname) { type = ArchiveObjectFileType::UNKNOWN; }
 	virtual ~ArchiveObjectFile() = default;
-	virtual std::vector<uint8_t> serialize() = 0;
+	// exact number of bytes serialize_into() will write, header not included
+	virtual size_t serialized_size() = 0;
+	virtual void serialize_into(Memory::OutputMemoryStream& stream) = 0;
+	std::vector<uint8_t> serialize();
 
 	using FactoryFunc = std::function<std::shared_ptr<ArchiveObjectFile>(
-        const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname)>;
+        const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname, std::shared_ptr<const void> source)>;
 
 	// fabric method
-    static std::shared_ptr<ArchiveObjectFile> from_bytes(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname);
+	// source is an optional owner of the memory behind buffer (e.g. a MappedFile). When it's set, parsed sections
+	// reference their payloads in place instead of copying them
+    static std::shared_ptr<ArchiveObjectFile> from_bytes(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname,
+                                                         std::shared_ptr<const void> source = nullptr);
     std::string filename() { return std::string(_filename); }
-    size_t size() { return Utils::Convenient::parse_decimal(Utils::Convenient::trim(std::string(header.ar_size))); }
+    size_t size() { return Utils::Convenient::parse_decimal(Utils::Convenient::trim(std::string(header.ar_size, sizeof(header.ar_size)))); }
+    // rewrites ar_size field of the header
+    void size(size_t sz);
     static void register_factory(ElfMan::ArchiveObjectFileType type, ElfMan::ArchiveObjectFile::FactoryFunc func);
+    // resolves trimmed ar_name into a filename, "/<offset>" names are looked up in GNU long filename table
+    static std::string member_name(const std::string& rawName, const std::string& nameTable);
+    // modification state. Edits made through the API mark members themselves,
+    // code changing public fields (symhdr, rhdr, ehdr...) directly must call mark_dirty()
+    bool modified() const { return dirty; }
+    void mark_dirty() { dirty = true; if (modified_flag) modified_flag->store(true, std::memory_order_relaxed); }
+    // raised together with our own state when set, so a container can tell whether some member changed
+    // without asking every one of them
+    std::shared_ptr<std::atomic<bool>> modified_flag;
 
 	struct ar_hdr header; // archive header
 	static const std::string name_table_name;
     static const std::string symbol_table_name;
     ArchiveObjectFileType type;
+protected:
+	bool dirty = false;
 private:
 	std::string _filename;
 	static std::map<ElfMan::ArchiveObjectFileType, FactoryFunc>& registry();
@@ -64,34 +89,133 @@ private:
 class StringTable : public ArchiveObjectFile
 {
 public:
-	StringTable(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname)
-	: data(buffer, buffer + total_sz), ArchiveObjectFile(hdr, fname) { type = ArchiveObjectFileType::STRING_TABLE; }
+	StringTable(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname,
+	            std::shared_ptr<const void> src = nullptr)
+	: ArchiveObjectFile(hdr, fname), data(buffer, total_sz, src) { type = ArchiveObjectFileType::STRING_TABLE; }
 	virtual ~StringTable(){}
-	virtual std::vector<uint8_t> serialize() { return data; };
-	std::vector<uint8_t> data;
+	virtual size_t serialized_size() { return data.size(); }
+	virtual void serialize_into(Memory::OutputMemoryStream& stream) { stream.write(data.data(), data.size()); }
+	Memory::CowBuffer data;
 private:
 	static bool registered;
 };
 //------------------------------------------------------------------------------------------------------------------------------
+// archive member which was only indexed by its ar header. It is parsed on demand with parse(),
+// until then it's written back from its original bytes
+class UnparsedMember : public ArchiveObjectFile
+{
+public:
+	UnparsedMember(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname,
+	               std::shared_ptr<const void> src = nullptr);
+	virtual ~UnparsedMember(){}
+	virtual size_t serialized_size() { return data.size(); }
+	virtual void serialize_into(Memory::OutputMemoryStream& stream) { stream.write(data.data(), data.size()); }
+	std::shared_ptr<ArchiveObjectFile> parse();
+	const uint8_t* bytes() const { return data.data(); }
+private:
+	Memory::CowBuffer data;
+};
+//------------------------------------------------------------------------------------------------------------------------------
 class ObjectFile : public ArchiveObjectFile
 {
+	// Symbol and relocation tables of sections, section containers and lookups are bump allocated from here
+	// and released at once. Sections themselves live on the heap and hold a reference to the arena,
+	// so it's released with the object or its last section handed out, whichever goes later.
+	// Declared first, so it outlives everything of the object allocated from it
+	std::shared_ptr<std::pmr::monotonic_buffer_resource> arena;
 public:
-	ObjectFile(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname);
-	virtual std::vector<uint8_t> serialize();
+	ObjectFile(const uint8_t* buffer, uint32_t total_sz, struct ar_hdr hdr, std::string fname,
+               std::shared_ptr<const void> src = nullptr);
+	virtual size_t serialized_size();
+	virtual void serialize_into(Memory::OutputMemoryStream& stream);
+	// assigns final section offsets and section header table offset, returns resulting object size
+	size_t layout();
 	void move_section_offsets(uint32_t addr, int addend);
-	void reorder_symtab_and_relocations();
+	// moves global symbols after local ones and fixes relocations up.
+	// returns the old index -> new index permutation that was applied (identity if nothing moved)
+	std::vector<uint32_t> reorder_symtab_and_relocations();
+	// rewrites symbol indexes of relocations and group signatures referring to our symbol table, entry i becomes permutation[i]
+	void remap_relocations(const std::vector<uint32_t>& permutation);
+	// incremental reorder: only symbols rebound since the last reorder cross the local/global boundary,
+	// only the index range between them is renumbered and only relocations (and group signatures) referencing it
+	// are rewritten.
+	// returns false if there was nothing to move
+	bool reorder_changed_symbols();
+	// retargets every relocation referencing symbol src_ind to dest_ind, through the reverse index below,
+	// so the cost depends on the number of references rather than on the number of relocations
 	void move_relocations(int src_ind, int dest_ind);
-	std::shared_ptr<ElfMan::Symbol> insert_undefined_global_function(std::string name, bool thumb);
-	std::shared_ptr<ElfMan::Symbol> find_symbol(std::string sym_name);
-	std::shared_ptr<ElfMan::Symbol> rename_symbol(std::string old_name, std::string new_name);
+	// relocations referencing the symbol
+	std::vector<Rel> relocations_of(const Symbol& symbol);
+	// drops the reverse index, it's rebuilt on next use. Needed after relocations were retargeted behind our back
+	void invalidate_relocation_index() { relocations_indexed = false; }
+	// moves the relocation from the list of symbol old_index to the one of the symbol it references now,
+	// called by Rel::retarget()
+	void relocation_retargeted(const Rel& rel, uint32_t old_index);
+	ElfMan::Symbol insert_undefined_global_function(std::string name, bool thumb);
+	// same without any size and offset fixups, those are left to the next layout(). For batches of edits
+	ElfMan::Symbol append_undefined_global_function(const std::string& name, bool thumb);
+	ElfMan::Symbol find_symbol(std::string sym_name);
+	// any length is fine. The new name reuses an identical string or overwrites the old one when it fits
+	// and isn't shared with other symbols, otherwise it's appended to the string table
+	ElfMan::Symbol rename_symbol(std::string old_name, std::string new_name);
+	// rebuilds symbol string table out of the names still in use, dropping strings left behind by renames.
+	// duplicates and names which are tails of other names are merged (see StringTableBuilder).
+	// returns the number of bytes reclaimed
+	size_t compact_symbol_strtab();
+	// same for both symbol and section name string tables
+	size_t merge_string_tables();
+	// new name for a symbol, false keeps the old one. Called for every named symbol except section ones
+	using SymbolRenameRule = std::function<bool(const Elf32_Sym& symhdr, std::string_view name, std::string& new_name)>;
+	// bulk rename: one pass over the symbol table, then the string table and name lookup are rebuilt once
+	// (merged like merge_string_tables() does). Returns the number of renamed symbols
+	size_t rename_symbols(const SymbolRenameRule& rule);
+	// bulk binding / visibility edit: one pass over the symbol table, one reorder at the end.
+	// Returns the number of changed symbols
+	size_t change_bindings(const BindingChanges& changes);
+	// merge string tables every time a modified object is serialized. Unmodified ones are still written verbatim
+	void merge_strings_on_write(bool enable = true) { merge_strings = enable; }
+	std::pmr::memory_resource* memory() { return arena.get(); }
+	std::shared_ptr<std::pmr::memory_resource> memory_owner() { return arena; }
+	// names this object contributes to the archive symbol map: defined global, weak and unique symbols in symtab order
+	std::vector<std::string> defined_global_symbols();
 public:
 	Elf32_Ehdr ehdr; // ELF file header
-	std::vector<std::shared_ptr<Section>> sections_by_index;
-	std::map<uint32_t, std::shared_ptr<Section>> sections; 
+	std::pmr::vector<std::shared_ptr<Section>> sections_by_index{arena.get()};
+	std::pmr::map<uint32_t, std::shared_ptr<Section>> sections{arena.get()};
 	std::shared_ptr<SymbolSection> symtab_section;
 	std::shared_ptr<RawSection> symbol_strtab_section;
 	std::shared_ptr<RawSection> section_strtab_section;
+	std::shared_ptr<const void> source; // owner of the image borrowed sections point into, may be null
+	// called after a symbol was added (old_name is empty) or renamed, lets indexes built on top of us follow
+	std::function<void(const Symbol& symbol, const std::string& old_name)> symbol_changed;
 private:
+	// symbol -> referencing relocations. Lists are keyed by symbol handle id, so symtab reorders don't affect them,
+	// and are singly linked through one flat array. Built on first use
+	struct RelocationRef {
+		uint32_t section;  // index in sections_by_index
+		uint32_t position; // entry in that section
+		uint32_t next;
+	};
+	static constexpr uint32_t no_ref = UINT32_MAX;
+	void index_relocations();
+	std::pmr::vector<RelocationRef> relocation_refs{arena.get()};
+	std::pmr::vector<uint32_t> relocation_heads{arena.get()};
+	std::pmr::vector<uint32_t> relocation_tails{arena.get()};
+	bool relocations_indexed = false;
+	// sorted string table offsets referenced by symbols (and by sections, if they share the table),
+	// tells whether other names are tails of a string, so it can't be overwritten in place. Built on first rename
+	void index_name_references();
+	void track_name_reference(uint32_t offset);
+	bool name_shared(uint32_t offset, size_t length);
+	std::pmr::vector<uint32_t> name_references{arena.get()};
+	bool name_references_valid = false;
+	// regenerates the table rewriting st_name / sh_name pointing into it, only applied if the table shrinks.
+	// symbol_names, if given, replaces names of symbols by table position (empty ones are kept)
+	size_t rebuild_string_table(const std::shared_ptr<RawSection>& strtab, const std::vector<std::string>* symbol_names = nullptr);
+	bool merge_strings = false;
+	// bytes the object was parsed from, kept only when they are borrowed from a source image.
+	// an unmodified object is written back from them verbatim
+	Memory::CowBuffer original;
 	static bool registered;
 };
 //------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+/*
+ * Auto-added header
+ * File: parallel.h
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#ifndef ELFMAN_PARALLEL_H
+#define ELFMAN_PARALLEL_H
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stddef.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+//------------------------------------------------------------------------------------------------------------------------------
+namespace ElfMan
+{
+//------------------------------------------------------------------------------------------------------------------------------
+namespace Parallel
+{
+//------------------------------------------------------------------------------------------------------------------------------
+inline unsigned default_workers()
+{
+	unsigned n = std::thread::hardware_concurrency();
+	return n ? n : 1;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+// calls func(i) for every i in [0, count) on up to `workers` threads (0 means one per core).
+// indexes are handed out one by one, so uneven work items balance themselves.
+// first exception thrown by func is rethrown in the calling thread once all workers are done
+template <typename Func>
+void for_each_index(size_t count, unsigned workers, Func func)
+{
+	if (!workers)
+		workers = default_workers();
+	workers = (unsigned)std::min<size_t>(workers, count);
+	if (workers <= 1) {
+		for (size_t i = 0; i < count; i++)
+			func(i);
+		return;
+	}
+	std::atomic<size_t> next(0);
+	std::atomic<bool> failed(false);
+	std::exception_ptr error;
+	std::mutex error_mutex;
+	auto worker = [&]() {
+		for (size_t i = next++; i < count && !failed; i = next++) {
+			try {
+				func(i);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(error_mutex);
+				if (!error)
+					error = std::current_exception();
+				failed = true;
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned i = 1; i < workers; i++)
+		pool.emplace_back(worker);
+	// calling thread takes its share too
+	worker();
+	for (auto& thread : pool)
+		thread.join();
+	if (error)
+		std::rethrow_exception(error);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+} // Parallel
+//------------------------------------------------------------------------------------------------------------------------------
+} // ElfMan
+//------------------------------------------------------------------------------------------------------------------------------
+#endif/*ELFMAN_PARALLEL_H*/
@@ -24,15 +24,21 @@ namespace ElfMan
 //------------------------------------------------------------------------------------------------------------------------------
 class RawSection : public Section {
 public:
-    RawSection(Elf32_Shdr* header, const uint8_t* buffer, uint32_t total_sz, ObjectFile* obj)
-        : Section(header, obj), data(total_sz)
-    {
-        memcpy(data.data(), buffer, total_sz);
+    RawSection(Elf32_Shdr* header, const uint8_t* buffer, uint32_t total_sz, ObjectFile* obj);
+    virtual uint32_t serialized_size() { return payload_size(); }
+    virtual void serialize_into(Memory::OutputMemoryStream& stream) {
+        stream.write(bytes(), payload_size());
     }
-    virtual std::vector<uint8_t> serialize() {
-        return data;
-    }
-    std::vector<uint8_t> data;
+    // payload for reading, either borrowed from the source image or our own copy
+    const uint8_t* bytes() const { return data.data(); }
+    size_t payload_size() const { return data.size(); }
+    // payload for writing, a borrowed payload is copied out of the source image on first call
+    std::vector<uint8_t>& mutable_data();
+    // replaces the payload, borrowed bytes aren't copied out first
+    void assign(std::vector<uint8_t>&& bytes) { data.assign(std::move(bytes)); mark_dirty(); }
+    bool borrowed() const { return data.borrowed(); }
+private:
+    Memory::CowBuffer data;
 };
 //------------------------------------------------------------------------------------------------------------------------------
 } //namespace ElfMan
@@ -12,43 +12,43 @@
 #include "symbol.h"
 #include "object_file.h"
 #include "rel.h"
+#include "relocation_section.h"
 #include "logger.h"
 //------------------------------------------------------------------------------------------------------------------------------
-ElfMan::Rel::Rel(Elf32_Rel* header, ElfMan::ObjectFile* obj)
+Elf32_Rel& ElfMan::Rel::header() const
 {
-	rhdr = *header;
-	object = obj;
+	return parent->entries[position];
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::vector<uint8_t> ElfMan::Rel::serialize()
+void ElfMan::Rel::retarget(uint32_t symbol_index) const
 {
-	std::vector<uint8_t> result;
-	result.insert(result.end(), (char*)&rhdr, (char*)&rhdr+sizeof(rhdr));
-	return result;
+	Elf32_Rel& rhdr = header();
+	uint32_t old_index = ELF32_R_SYM(rhdr.r_info);
+	if (old_index == symbol_index)
+		return;
+	rhdr.r_info = ELF32_R_INFO(symbol_index, ELF32_R_TYPE(rhdr.r_info));
+	parent->mark_dirty();
+	parent->object_file()->relocation_retargeted(*this, old_index);
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::shared_ptr<ElfMan::Section> ElfMan::Rel::section_to_modify()
+std::shared_ptr<ElfMan::Section> ElfMan::Rel::section_to_modify() const
 {
-	std::shared_ptr<ElfMan::Section> parent = parent_ptr.lock();
-	if (parent)
+	ObjectFile* object = parent->object_file();
+	if (parent->info() < object->sections_by_index.size())
 		return object->sections_by_index[parent->info()];
 	else
 		return nullptr;
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::shared_ptr<ElfMan::Symbol> ElfMan::Rel::symbol_to_apply() // Note! search by index!
+ElfMan::Symbol ElfMan::Rel::symbol_to_apply() const // Note! search by index!
 {
-	std::shared_ptr<ElfMan::Section> parent = parent_ptr.lock();
-	if (parent)
-	{
-		LOG_DEBUG("\tparent section is %d, link section id %d, symbol offset %d", parent->index, parent->link(),
-																	ELF32_R_SYM(rhdr.r_info));
-		std::shared_ptr<SymbolSection> symtab = std::dynamic_pointer_cast<SymbolSection>(object->sections_by_index[parent->link()]);
-		return symtab->symbols[ELF32_R_SYM(rhdr.r_info)];
-	}
-	else
-	{
-		return nullptr;
-	}
+	ObjectFile* object = parent->object_file();
+	LOG_DEBUG("\tparent section is %d, link section id %d, symbol offset %d", parent->index, parent->link(), symbol_index());
+	if (parent->link() >= object->sections_by_index.size())
+		return Symbol();
+	std::shared_ptr<SymbolSection> symtab = std::dynamic_pointer_cast<SymbolSection>(object->sections_by_index[parent->link()]);
+	if (!symtab || symbol_index() >= symtab->count())
+		return Symbol();
+	return symtab->at(symbol_index());
 }
 //------------------------------------------------------------------------------------------------------------------------------
@@ -17,23 +17,34 @@
 #include <memory>
 #include <elf.h>
 //------------------------------------------------------------------------------------------------------------------------------
+#include "memory_helpers.h"
+#include "symbol.h"
+//------------------------------------------------------------------------------------------------------------------------------
 namespace ElfMan
 {
 //------------------------------------------------------------------------------------------------------------------------------
 class ObjectFile;
-class Symbol;
+class Section;
+class RelocationSection;
 //------------------------------------------------------------------------------------------------------------------------------
+// View of one entry of a relocation section. Entries are stored as a flat Elf32_Rel array in their RelocationSection,
+// a view is only the section and a position in it
 class Rel
 {
 public:
-	Rel(Elf32_Rel* header, ElfMan::ObjectFile* obj);
-	std::vector<uint8_t> serialize();
-	Elf32_Rel rhdr;
-	std::weak_ptr<Section> parent_ptr;
-	int index = 0;
-	ObjectFile* object;
-	std::shared_ptr<Section> section_to_modify();
-	std::shared_ptr<Symbol> symbol_to_apply();
+	Rel(RelocationSection* section, uint32_t index) : parent(section), position(index) {}
+	Elf32_Rel& header() const;
+	uint32_t index() const { return position; }
+	uint32_t symbol_index() const { return ELF32_R_SYM(header().r_info); }
+	uint32_t type() const { return ELF32_R_TYPE(header().r_info); }
+	// points the relocation to another symbol table entry
+	void retarget(uint32_t symbol_index) const;
+	RelocationSection* section() const { return parent; }
+	std::shared_ptr<Section> section_to_modify() const;
+	Symbol symbol_to_apply() const;
+private:
+	RelocationSection* parent;
+	uint32_t position;
 };
 //------------------------------------------------------------------------------------------------------------------------------
 }//namespace ElfMan
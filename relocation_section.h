@@ -15,6 +15,7 @@
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <cstring>
 #include <elf.h>
 //------------------------------------------------------------------------------------------------------------------------------
 #include "section.h"
@@ -30,26 +31,23 @@ public:
     RelocationSection(Elf32_Shdr* header, const uint8_t* buffer, uint32_t total_sz, ObjectFile* obj)
         : Section(header, obj)
     {
-        ElfMan::Memory::InputMemoryStream stream(buffer, total_sz);
-        int index = 0;
-        while (stream.size()) {
-            Elf32_Rel rhdr;
-            stream.read(rhdr);
-            LOG_DEBUG("found relocation r_offset 0x%08X, r_info 0x%08X", rhdr.r_offset, rhdr.r_info);
-            auto rel = std::make_shared<ElfMan::Rel>(&rhdr, obj);
-            relocations.push_back(rel);
-            rel->index = index++;
+        if (total_sz % sizeof(Elf32_Rel)) {
+            LOG_ERROR("relocation table size %u is not a multiple of %ld", total_sz, sizeof(Elf32_Rel));
+            throw malformed_object("Truncated relocation table");
         }
+        // whole section in one copy, Rel views index into it
+        entries.resize(total_sz / sizeof(Elf32_Rel));
+        memcpy(entries.data(), buffer, entries.size() * sizeof(Elf32_Rel));
+        LOG_DEBUG("found %ld relocation(s)", entries.size());
     }
-    virtual std::vector<uint8_t> serialize() {
-        std::vector<uint8_t> result;
-        for (auto rel : relocations)
-        {
-            result.insert(result.end(), (char*)&rel->rhdr, (char*)&rel->rhdr+sizeof(rel->rhdr));
-        }
-        return result;
+    virtual uint32_t serialized_size() { return entries.size() * sizeof(Elf32_Rel); }
+    virtual void serialize_into(Memory::OutputMemoryStream& stream) {
+        stream.write((const uint8_t*)entries.data(), entries.size() * sizeof(Elf32_Rel));
     }
-    std::vector<std::shared_ptr<ElfMan::Rel>> relocations;
+    uint32_t count() const { return entries.size(); }
+    Rel at(uint32_t index) { return Rel(this, index); }
+    // raw relocation table, in file order
+    std::pmr::vector<Elf32_Rel> entries{memory()};
 
 private:
     static bool registered;
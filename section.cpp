@@ -40,6 +40,29 @@ std::shared_ptr<ElfMan::Section> ElfMan::Section::from_bytes(
     return std::make_shared<RawSection>(header, buffer, total_sz, obj);
 }
 //------------------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<std::pmr::memory_resource> ElfMan::Section::arena_of(ObjectFile* obj)
+{
+    if (obj)
+        return obj->memory_owner();
+    // sections without an object use the heap, nothing to keep alive then
+    return std::shared_ptr<std::pmr::memory_resource>(std::shared_ptr<void>(), std::pmr::get_default_resource());
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::Section::mark_dirty()
+{
+    dirty = true;
+    if (object)
+        object->mark_dirty();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::vector<uint8_t> ElfMan::Section::serialize()
+{
+    std::vector<uint8_t> result(serialized_size());
+    ElfMan::Memory::OutputMemoryStream stream(result.data(), result.size());
+    serialize_into(stream);
+    return result;
+}
+//------------------------------------------------------------------------------------------------------------------------------
 std::string ElfMan::Section::name()
 {
 	if(!object)
@@ -47,7 +70,21 @@ std::string ElfMan::Section::name()
 	std::shared_ptr<RawSection> strtab = object->section_strtab_section;
 	if(!strtab || shdr.sh_name >= strtab->shdr.sh_size)
 		return "*error2*";
-	return std::string((char*)&strtab->data.data()[shdr.sh_name]);
+	return std::string((char*)&strtab->bytes()[shdr.sh_name]);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::RawSection::RawSection(Elf32_Shdr* header, const uint8_t* buffer, uint32_t total_sz, ObjectFile* obj)
+    : Section(header, obj), data(buffer, total_sz, obj ? obj->source : nullptr)
+{
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::vector<uint8_t>& ElfMan::RawSection::mutable_data()
+{
+    if (data.borrowed())
+        LOG_DEBUG("section %d: copying %lu bytes out of source image", index, data.size());
+    // we can't tell what the caller is going to change, so taking the payload for writing counts as a change
+    mark_dirty();
+    return data.mutable_data();
 }
 //------------------------------------------------------------------------------------------------------------------------------
 bool ElfMan::RelocationSection::registered = []{
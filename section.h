@@ -17,8 +17,11 @@
 #include <algorithm>
 #include <memory>
 #include <map>
+#include <memory_resource>
 #include <elf.h>
 //------------------------------------------------------------------------------------------------------------------------------
+#include "memory_helpers.h"
+//------------------------------------------------------------------------------------------------------------------------------
 namespace ElfMan
 {
 //------------------------------------------------------------------------------------------------------------------------------
@@ -26,13 +29,16 @@ class ObjectFile;
 //------------------------------------------------------------------------------------------------------------------------------
 class Section {
 public:
-    Section(Elf32_Shdr* header, ObjectFile* obj) {
+    Section(Elf32_Shdr* header, ObjectFile* obj) : arena(arena_of(obj)) {
         memcpy(&shdr, header, sizeof(shdr));
         object = obj;
     }
 
     virtual ~Section() = default;
-    virtual std::vector<uint8_t> serialize() = 0;
+    // exact number of bytes serialize_into() will write
+    virtual uint32_t serialized_size() = 0;
+    virtual void serialize_into(Memory::OutputMemoryStream& stream) = 0;
+    std::vector<uint8_t> serialize();
 	std::string name();
 	// getters
 	uint32_t name_index() { return shdr.sh_name; }
@@ -43,10 +49,15 @@ public:
 	uint32_t addralign() { return shdr.sh_addralign; }
     uint32_t type() const { return shdr.sh_type; }
     const Elf32_Shdr* header() const { return &shdr; } 
+    ObjectFile* object_file() const { return object; }
 	// setters
-	void offset(uint32_t off) { shdr.sh_offset = off; }
-	void info(uint32_t inf) { shdr.sh_info = inf; }
-	void size(uint32_t sz) { shdr.sh_size = sz; }
+	void offset(uint32_t off) { if (off != shdr.sh_offset) { shdr.sh_offset = off; mark_dirty(); } }
+	void info(uint32_t inf) { if (inf != shdr.sh_info) { shdr.sh_info = inf; mark_dirty(); } }
+	void size(uint32_t sz) { if (sz != shdr.sh_size) { shdr.sh_size = sz; mark_dirty(); } }
+	void name_index(uint32_t name) { if (name != shdr.sh_name) { shdr.sh_name = name; mark_dirty(); } }
+	// modification state, marking a section also marks its object
+	bool modified() const { return dirty; }
+	void mark_dirty();
 
     using FactoryFunc = std::function<std::shared_ptr<Section>(
         Elf32_Shdr*, const uint8_t*, uint32_t, ObjectFile*)>;
@@ -57,14 +68,23 @@ public:
         const uint8_t* buffer,
         uint32_t total_sz,
         ObjectFile* obj);
+    // symbol and relocation tables are allocated from the arena of their object (see ObjectFile::memory())
+    std::pmr::memory_resource* memory() const { return arena.get(); }
 
     int index = 0;
+    // zero pad the linker left in front of this section beyond its alignment, kept by ObjectFile::layout()
+    uint32_t leading_gap = 0;
 
     static void register_factory(uint32_t sh_type, FactoryFunc func);
 
+private:
+    static std::shared_ptr<std::pmr::memory_resource> arena_of(ObjectFile* obj);
+    // keeps the arena alive while the section is. Base class member, so it goes after tables of derived sections
+    std::shared_ptr<std::pmr::memory_resource> arena;
 protected:
     Elf32_Shdr shdr;
     ObjectFile* object;
+    bool dirty = false;
 private:
 	static std::map<uint32_t, FactoryFunc>& registry();
 };
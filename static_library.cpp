@@ -9,22 +9,58 @@
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <cerrno>
 #include <elf.h>
 #include <ar.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <endian.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <string_view>
 //------------------------------------------------------------------------------------------------------------------------------
 #include "static_library.h"
 #include "object_file.h"
+#include "parallel.h"
 #include "convenient.h"
 #include "logger.h"
 //------------------------------------------------------------------------------------------------------------------------------
+ElfMan::StaticLibrary::StaticLibrary(const std::vector<uint8_t>& data, ParseMode mode, unsigned workers)
+ : workers(workers)
+{
+    // caller owns the buffer, so parsed sections and members take their own copies
+    parse(data.data(), data.size(), nullptr, mode);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::StaticLibrary::StaticLibrary(std::vector<uint8_t>&& data, ParseMode mode, unsigned workers)
+ : workers(workers)
+{
+    auto image = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+    parse(image->data(), image->size(), image, mode);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::StaticLibrary::StaticLibrary(std::shared_ptr<const MappedFile> file, ParseMode mode, unsigned workers)
+ : workers(workers)
+{
+    if (!file)
+        throw std::runtime_error("Not a valid ar archive");
+    parse(file->data(), file->size(), file, mode);
+}
+//------------------------------------------------------------------------------------------------------------------------------
 // Parse AR archive
-ElfMan::StaticLibrary::StaticLibrary(const std::vector<uint8_t>& data)
+void ElfMan::StaticLibrary::parse(const uint8_t* buffer, size_t total_sz, std::shared_ptr<const void> source, ParseMode mode)
 {
     // Check global archive magic + header length
-    if (data.size() < SARMAG + sizeof(struct ar_hdr))
+    if (total_sz < SARMAG + sizeof(struct ar_hdr))
         throw std::runtime_error("Not a valid ar archive");
+    if (source) {
+        image = source;
+        image_data = buffer;
+        image_size = total_sz;
+    }
 
-    ElfMan::Memory::InputMemoryStream library_stream(data.data(), data.size());
+    ElfMan::Memory::InputMemoryStream library_stream(buffer, total_sz);
     // read Magic bytes
     char magic[SARMAG] = {0};
     library_stream.read(magic);
@@ -32,9 +68,20 @@ ElfMan::StaticLibrary::StaticLibrary(const std::vector<uint8_t>& data)
     if (memcmp(magic, ARMAG, SARMAG))
         throw std::runtime_error("Not a valid ar archive");
 
-    std::vector<uint8_t> object;
+    // members left for the worker pool in PARALLEL mode, their slots in objects are reserved during the header walk
+    // so the order of objects doesn't depend on which worker finishes first
+    struct PendingMember {
+        size_t slot;
+        const uint8_t* buffer;
+        size_t size;
+        struct ar_hdr header;
+        std::string filename;
+    };
+    std::vector<PendingMember> pending;
+
     struct ar_hdr header;
     while (library_stream) {
+        member_offsets.push_back(library_stream.pointer() - buffer);
         library_stream.read(header);
         if (Utils::Convenient::trim(std::string(header.ar_fmag, sizeof(header.ar_fmag))) != "`\n") {
             throw std::runtime_error("Invalid file header magic in ar header");
@@ -43,60 +90,368 @@ ElfMan::StaticLibrary::StaticLibrary(const std::vector<uint8_t>& data)
         std::string filename;
         std::string rawName = Utils::Convenient::trim(std::string(header.ar_name, sizeof(header.ar_name)));
         LOG_DEBUG("reading object file %s, size %ld\n", rawName.c_str(), filesize);
-        library_stream.read(object, filesize);
+        if (!library_stream.can_read(filesize))
+            throw malformed_object();
+        member_sizes.push_back(filesize);
+        // member payload is used in place, no intermediate copy
+        const uint8_t* object = library_stream.pointer();
+        library_stream.skip(filesize);
         filename = rawName;
         if (rawName == ElfMan::ArchiveObjectFile::symbol_table_name) {
             // this is a special object, Long filename string table
-            symbolTable.assign(object.begin(), object.end());
+            symbolTable.assign((const char*)object, filesize);
         }
         else if (rawName == ElfMan::ArchiveObjectFile::name_table_name) {
             // this is a special object, Long filename string table
-            nameTable.assign(object.begin(), object.end());
+            nameTable.assign((const char*)object, filesize);
         }
-        else if (!rawName.empty() && rawName[0] == '/' && rawName.size() > 1) {
-            // Long filename reference into string table
-            size_t offsetInTable = std::stoul(rawName.substr(1));
-            if (offsetInTable >= nameTable.size()) {
-                LOG_ERROR("Invalid string table offset %ld\n", offsetInTable);
-                throw std::runtime_error("Invalid string table offset");
-            }
-            size_t endPos = nameTable.find('/', offsetInTable);
-            if (endPos == std::string::npos) {
-                endPos = nameTable.find('\n', offsetInTable);
-            }
-            if (endPos == std::string::npos) {
-                throw std::runtime_error("Unterminated filename in string table");
-            }
-            filename = nameTable.substr(offsetInTable, endPos - offsetInTable);
-        } 
         else {
-            // Normal short name
-            // don't change it
+            filename = ElfMan::ArchiveObjectFile::member_name(rawName, nameTable);
         }
-        std::shared_ptr<ElfMan::ArchiveObjectFile> archive_obj = ElfMan::ArchiveObjectFile::from_bytes(object.data(), object.size(), header, filename);
+        std::shared_ptr<ElfMan::ArchiveObjectFile> archive_obj;
+        // string tables are always needed (and small), so they are never deferred
+        bool special = rawName == ElfMan::ArchiveObjectFile::symbol_table_name || rawName == ElfMan::ArchiveObjectFile::name_table_name;
+        if (mode == ParseMode::LAZY && !special)
+            archive_obj = std::make_shared<ElfMan::UnparsedMember>(object, filesize, header, filename, source);
+        else if (mode == ParseMode::PARALLEL && !special)
+            pending.push_back(PendingMember{objects.size(), object, filesize, header, filename});
+        else
+            archive_obj = ElfMan::ArchiveObjectFile::from_bytes(object, filesize, header, filename, source);
         objects.push_back(archive_obj);
     }
+
+    symbol_map_offsets = member_offsets;
+    if (!pending.empty()) {
+        LOG_DEBUG("parsing %ld archive members on %u workers", pending.size(), workers ? workers : Parallel::default_workers());
+        // members are independent, every worker only writes its own slot
+        Parallel::for_each_index(pending.size(), workers, [&](size_t i) {
+            PendingMember& member = pending[i];
+            objects[member.slot] = ElfMan::ArchiveObjectFile::from_bytes(member.buffer, member.size, member.header, member.filename, source);
+        });
+    }
+    for (auto& object : objects)
+        if (ArchiveObjectFileType::ELF_OBJECT == object->type)
+            object->modified_flag = members_modified;
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::vector<uint8_t> ElfMan::StaticLibrary::serialize()
+std::shared_ptr<ElfMan::ArchiveObjectFile> ElfMan::StaticLibrary::get_object(size_t index)
 {
-    // archive magic bytes
-    std::vector<uint8_t> data(ARMAG, ARMAG+SARMAG);
-
-    for (auto& object : getObjects()) {
-        std::vector<uint8_t> object_data = object->serialize();
+    if (index >= objects.size())
+        return nullptr;
+    if (ArchiveObjectFileType::UNPARSED == objects[index]->type) {
+        // parsed object replaces the placeholder, so every member is parsed at most once
+        objects[index] = std::static_pointer_cast<UnparsedMember>(objects[index])->parse();
+        if (ArchiveObjectFileType::ELF_OBJECT == objects[index]->type)
+            objects[index]->modified_flag = members_modified;
+        if (merge_strings && ArchiveObjectFileType::ELF_OBJECT == objects[index]->type)
+            std::static_pointer_cast<ObjectFile>(objects[index])->merge_strings_on_write(true);
+    }
+    return objects[index];
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<ElfMan::ObjectFile> ElfMan::StaticLibrary::get_object(const std::string& filename)
+{
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (objects[i]->filename() != filename)
+            continue;
+        if (auto objfile = elf_object(i))
+            return objfile;
+    }
+    return nullptr;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<ElfMan::ObjectFile> ElfMan::StaticLibrary::elf_object(size_t index)
+{
+    std::shared_ptr<ArchiveObjectFile> object = get_object(index);
+    if (!object || ArchiveObjectFileType::ELF_OBJECT != object->type)
+        return nullptr;
+    return std::static_pointer_cast<ObjectFile>(object);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::StaticLibrary::merge_strings_on_write(bool enable)
+{
+    merge_strings = enable;
+    // members still unparsed get it when they are parsed, until then they can't be modified anyway
+    for (auto& object : objects)
+        if (ArchiveObjectFileType::ELF_OBJECT == object->type)
+            std::static_pointer_cast<ObjectFile>(object)->merge_strings_on_write(enable);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::StaticLibrary::serialized_size()
+{
+    // phase 1: members lay themselves out independently, which gives us their final sizes
+    Parallel::for_each_index(objects.size(), workers, [&](size_t i) {
+        size_t size = objects[i]->serialized_size();
         // we should check and modify object file size if needed
-        LOG_DEBUG("file %s, old size %s, new size %s", object->header.ar_name, object->header.ar_size, std::to_string(object_data.size()).c_str());
-        snprintf((char*)&object->header.ar_size, sizeof(object->header.ar_size), "%s", std::to_string(object_data.size()).c_str());
-        memset(&((char*)&object->header.ar_size)[strlen((char*)&object->header.ar_size)], ' ', 
-                                                        (sizeof(object->header.ar_size) - strlen((char*)&object->header.ar_size)));
-        data.insert(data.end(), (const uint8_t*)&object->header, ((const uint8_t*)&object->header + sizeof(ar_hdr)));
-        data.insert(data.end(), object_data.begin(), object_data.end());
+        LOG_DEBUG("file %s, old size %ld, new size %ld", objects[i]->filename().c_str(), objects[i]->size(), size);
+        objects[i]->size(size);
+    });
+    // symbol map depends on member offsets, so it can only be brought up to date now
+    rebuild_symbol_map();
+    size_t total = SARMAG;
+    for (auto& object : objects)
+        total += sizeof(ar_hdr) + object->size();
+    return total;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::StaticLibrary::serialize_into(Memory::OutputMemoryStream& stream)
+{
+    // member sizes in headers must be up to date before we can place anything
+    size_t total = serialized_size();
+    if (stream.size() < total)
+        throw serialization_error();
+    uint8_t* start = stream.pointer();
+    // member offsets in the output, archive magic bytes come first
+    std::vector<size_t> offsets(objects.size());
+    size_t position = SARMAG;
+    for (size_t i = 0; i < objects.size(); i++) {
+        offsets[i] = position;
+        position += sizeof(ar_hdr) + objects[i]->size();
     }
-
+    stream.write((const uint8_t*)ARMAG, SARMAG);
+    // phase 2: every member writes itself straight into its own slice of the output
+    Parallel::for_each_index(objects.size(), workers, [&](size_t i) {
+        Memory::OutputMemoryStream slice(start + offsets[i], sizeof(ar_hdr) + objects[i]->size());
+        slice.write(objects[i]->header);
+        objects[i]->serialize_into(slice);
+    });
+    stream.skip(total - SARMAG);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::vector<uint8_t> ElfMan::StaticLibrary::serialize()
+{
+    std::vector<uint8_t> data(serialized_size());
+    Memory::OutputMemoryStream stream(data.data(), data.size());
+    serialize_into(stream);
     return data;
 }
 //------------------------------------------------------------------------------------------------------------------------------
+bool ElfMan::StaticLibrary::parse_symbol_map(const uint8_t* buffer, size_t size, std::vector<std::pair<uint32_t, std::string>>& entries)
+{
+    // big endian symbol count, then that many big endian member header offsets, then that many NUL terminated names
+    Memory::InputMemoryStream stream(buffer, size);
+    if (!stream.can_read(sizeof(uint32_t)))
+        return false;
+    uint32_t count = be32toh(stream.read<uint32_t>());
+    if (count > stream.size() / sizeof(uint32_t))
+        return false;
+    const uint8_t* offsets = stream.pointer();
+    stream.skip(count * sizeof(uint32_t));
+    const char* names = (const char*)stream.pointer();
+    const char* names_end = names + stream.size();
+    entries.reserve(entries.size() + count);
+    for (uint32_t i = 0; i < count; i++) {
+        const char* end = (const char*)memchr(names, 0, names_end - names);
+        if (!end)
+            return false;
+        uint32_t offset;
+        Memory::read_value(offsets + i * sizeof(uint32_t), offset);
+        entries.emplace_back(be32toh(offset), std::string(names, end));
+        names = end + 1;
+    }
+    return true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::StaticLibrary::symbol_map_size(const std::vector<std::vector<std::string>>& names)
+{
+    size_t size = sizeof(uint32_t);
+    for (auto& member_names : names)
+        for (auto& name : member_names)
+            size += sizeof(uint32_t) + name.size() + 1;
+    // members have to stay 2-byte aligned
+    return size + size % 2;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::vector<uint8_t> ElfMan::StaticLibrary::build_symbol_map(const std::vector<std::vector<std::string>>& names,
+                                                             const std::vector<size_t>& offsets)
+{
+    size_t count = 0;
+    for (auto& member_names : names)
+        count += member_names.size();
+    std::vector<uint8_t> data(symbol_map_size(names), 0);
+    Memory::OutputMemoryStream stream(data.data(), data.size());
+    stream.write(htobe32(count));
+    for (size_t i = 0; i < names.size(); i++)
+        for (size_t n = 0; n < names[i].size(); n++)
+            stream.write(htobe32(offsets[i]));
+    for (auto& member_names : names)
+        for (auto& name : member_names) {
+            stream.write((const uint8_t*)name.data(), name.size());
+            stream.fill(1, 0);
+        }
+    LOG_DEBUG("archive symbol map built, %ld symbol(s), %ld byte(s)", count, data.size());
+    return data;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::StaticLibrary::rebuild_symbol_map()
+{
+    size_t map_index = objects.size();
+    bool changed = false;
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (ArchiveObjectFileType::STRING_TABLE == objects[i]->type && objects[i]->filename() == ArchiveObjectFile::symbol_table_name)
+            map_index = i;
+        else if (ArchiveObjectFileType::ELF_OBJECT == objects[i]->type && objects[i]->modified())
+            changed = true;
+    }
+    // archive without a map stays without one, and untouched members keep both their symbols and offsets
+    if (map_index == objects.size() || !changed)
+        return;
+    std::shared_ptr<StringTable> map = std::static_pointer_cast<StringTable>(objects[map_index]);
+    // names of members we don't reparse come from the map as it is now
+    std::vector<std::pair<uint32_t, std::string>> old_entries;
+    if (!parse_symbol_map(map->data.data(), map->data.size(), old_entries)) {
+        LOG_ERROR("malformed archive symbol map, entries of unmodified members are dropped");
+        old_entries.clear();
+    }
+    std::unordered_map<uint32_t, size_t> member_by_offset;
+    for (size_t i = 0; i < symbol_map_offsets.size(); i++)
+        member_by_offset[symbol_map_offsets[i]] = i;
+    std::vector<std::vector<std::string>> names(objects.size());
+    for (auto& entry : old_entries) {
+        auto it = member_by_offset.find(entry.first);
+        if (it != member_by_offset.end() && !objects[it->second]->modified())
+            names[it->second].push_back(std::move(entry.second));
+    }
+    for (size_t i = 0; i < objects.size(); i++)
+        if (ArchiveObjectFileType::ELF_OBJECT == objects[i]->type && objects[i]->modified())
+            names[i] = std::static_pointer_cast<ObjectFile>(objects[i])->defined_global_symbols();
+    // the map's own size goes into the offsets of everything after it
+    size_t map_size = symbol_map_size(names);
+    map->size(map_size);
+    std::vector<size_t> offsets(objects.size());
+    size_t position = SARMAG;
+    for (size_t i = 0; i < objects.size(); i++) {
+        offsets[i] = position;
+        position += sizeof(ar_hdr) + objects[i]->size();
+    }
+    std::vector<uint8_t> data = build_symbol_map(names, offsets);
+    symbolTable.assign((const char*)data.data(), data.size());
+    map->data.assign(std::move(data));
+    map->mark_dirty();
+    symbol_map_offsets = std::move(offsets);
+    symbol_map_members.clear();
+    symbol_map_parsed = false;
+    // map is current again, until the next edit
+    members_modified->store(false);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+const std::unordered_map<std::string, size_t>& ElfMan::StaticLibrary::symbol_map_lookup()
+{
+    if (symbol_map_parsed)
+        return symbol_map_members;
+    symbol_map_parsed = true;
+    std::vector<std::pair<uint32_t, std::string>> entries;
+    if (!parse_symbol_map((const uint8_t*)symbolTable.data(), symbolTable.size(), entries)) {
+        LOG_ERROR("malformed archive symbol map, ignored");
+        return symbol_map_members;
+    }
+    std::unordered_map<uint32_t, size_t> member_by_offset;
+    for (size_t i = 0; i < symbol_map_offsets.size(); i++)
+        member_by_offset[symbol_map_offsets[i]] = i;
+    symbol_map_members.reserve(entries.size());
+    for (auto& entry : entries) {
+        auto it = member_by_offset.find(entry.first);
+        if (it == member_by_offset.end()) {
+            LOG_ERROR("archive symbol map entry %s points to %08X, which is not a member", entry.second.c_str(), entry.first);
+            continue;
+        }
+        // same as the linker, first definition wins
+        symbol_map_members.emplace(std::move(entry.second), it->second);
+    }
+    LOG_DEBUG("archive symbol map loaded, %ld name(s)", symbol_map_members.size());
+    return symbol_map_members;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+bool ElfMan::StaticLibrary::collect_patches(std::vector<Patch>& patches)
+{
+    if (!image) {
+        LOG_ERROR("in-place commit needs the original archive image");
+        return false;
+    }
+    // differing runs closer than this are merged into one write
+    const size_t merge_gap = 16;
+    std::vector<Patch> result;
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (!objects[i]->modified())
+            continue;
+        size_t size = objects[i]->serialized_size();
+        if (size != member_sizes[i]) {
+            LOG_INFO("member %s changed size %ld -> %ld, can't patch in place", objects[i]->filename().c_str(), member_sizes[i], size);
+            return false;
+        }
+        objects[i]->size(size);
+    }
+    // edits may have changed the symbol map, it's patched like any other member
+    rebuild_symbol_map();
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (!objects[i]->modified())
+            continue;
+        size_t size = objects[i]->serialized_size();
+        if (size != member_sizes[i]) {
+            LOG_INFO("member %s changed size %ld -> %ld, can't patch in place", objects[i]->filename().c_str(), member_sizes[i], size);
+            return false;
+        }
+        // only modified members are serialized, they are a small part of the archive
+        std::vector<uint8_t> member(sizeof(ar_hdr) + size);
+        Memory::OutputMemoryStream stream(member.data(), member.size());
+        stream.write(objects[i]->header);
+        objects[i]->serialize_into(stream);
+        const uint8_t* old = image_data + member_offsets[i];
+        size_t pos = 0;
+        while (pos < member.size()) {
+            if (member[pos] == old[pos]) {
+                pos++;
+                continue;
+            }
+            size_t start = pos, end = pos + 1, same = 0;
+            for (pos = end; pos < member.size() && same < merge_gap; pos++) {
+                if (member[pos] == old[pos])
+                    same++;
+                else {
+                    same = 0;
+                    end = pos + 1;
+                }
+            }
+            result.push_back(Patch{member_offsets[i] + start, std::vector<uint8_t>(member.begin() + start, member.begin() + end)});
+            pos = end;
+        }
+    }
+    patches.insert(patches.end(), std::make_move_iterator(result.begin()), std::make_move_iterator(result.end()));
+    return true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+bool ElfMan::StaticLibrary::patch_file(const std::string& path)
+{
+    // everything is computed before the first write, the file may be the very mapping we compare against
+    std::vector<Patch> patches;
+    if (!collect_patches(patches))
+        return false;
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("failed to open %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    size_t written = 0;
+    for (auto& patch : patches) {
+        size_t done = 0;
+        while (done < patch.bytes.size()) {
+            ssize_t res = pwrite(fd, patch.bytes.data() + done, patch.bytes.size() - done, patch.offset + done);
+            if (res < 0 && errno == EINTR)
+                continue;
+            if (res <= 0) {
+                LOG_ERROR("failed to write %s at 0x%lX: %s", path.c_str(), patch.offset + done, strerror(errno));
+                close(fd);
+                return false;
+            }
+            done += res;
+        }
+        written += done;
+    }
+    close(fd);
+    LOG_INFO("patched %ld byte(s) in %ld range(s) of %s", written, patches.size(), path.c_str());
+    return true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
 // Dump archive contents
 void ElfMan::StaticLibrary::dump() {
     LOG_DEBUG("Archive contains %d file(s)", objects.size());
@@ -105,37 +460,168 @@ void ElfMan::StaticLibrary::dump() {
     }
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::shared_ptr<ElfMan::Symbol> ElfMan::StaticLibrary::find_symbol(std::string sym_name)
+const ElfMan::SymbolIndex& ElfMan::StaticLibrary::symbol_index()
 {
-    for (auto &object : getObjects()) {
-        if (ArchiveObjectFileType::ELF_OBJECT != object->type)
+    if (symbols)
+        return *symbols;
+    symbols = std::make_shared<SymbolIndex>();
+    std::weak_ptr<SymbolIndex> weak_index = symbols;
+    for (size_t i = 0; i < objects.size(); i++) {
+        std::shared_ptr<ObjectFile> objfile = elf_object(i);
+        if (!objfile)
             continue;
-        std::shared_ptr<ObjectFile> objfile = std::dynamic_pointer_cast<ObjectFile>(object);
-        if (auto search = objfile->find_symbol(sym_name))
-            return search;
+        objfile->symtab_section->for_each_name([&](std::string_view name, const Symbol& symbol) {
+            symbols->add(i, symbol, std::string(name));
+        });
+        objfile->symbol_changed = [weak_index, i](const Symbol& symbol, const std::string& old_name) {
+            auto index = weak_index.lock();
+            if (!index)
+                return;
+            if (old_name.empty())
+                index->add(i, symbol, symbol.name());
+            else
+                index->rename(i, symbol, old_name, symbol.name());
+        };
     }
-    return nullptr;
+    LOG_DEBUG("symbol index built, %ld name(s)", symbols->size());
+    return *symbols;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::Symbol ElfMan::StaticLibrary::find_symbol(std::string sym_name)
+{
+    if (auto entry = symbol_index().find(sym_name))
+        return entry->symbol;
+    return Symbol();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::Symbol ElfMan::StaticLibrary::find_definition(std::string sym_name, bool global_only)
+{
+    // symbol map describes members as they were loaded (or last serialized), edits make it unreliable
+    if (!symbols && !*members_modified && !symbolTable.empty()) {
+        if (auto objfile = find_defining_object(sym_name)) {
+            Symbol symbol = objfile->symtab_section->find(sym_name);
+            if (symbol && symbol.defined())
+                return symbol;
+        }
+        // every global definition is in the map, only local ones still need the full index
+        if (global_only)
+            return Symbol();
+    }
+    if (!global_only) {
+        if (auto entry = symbol_index().find_defined(sym_name))
+            return entry->symbol;
+        return Symbol();
+    }
+    if (const std::vector<SymbolIndex::Entry>* entries = symbol_index().entries(sym_name))
+        for (auto& entry : *entries)
+            if (entry.symbol.defined() && entry.symbol.bind() != STB_LOCAL)
+                return entry.symbol;
+    return Symbol();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<ElfMan::ObjectFile> ElfMan::StaticLibrary::find_defining_object(const std::string& sym_name)
+{
+    const std::unordered_map<std::string, size_t>& lookup = symbol_map_lookup();
+    auto it = lookup.find(sym_name);
+    if (it == lookup.end())
+        return nullptr;
+    return elf_object(it->second);
 }
 //------------------------------------------------------------------------------------------------------------------------------
 bool ElfMan::StaticLibrary::rename_symbol(std::string old_name, std::string new_name)
 {
+    const std::vector<SymbolIndex::Entry>* found = symbol_index().entries(old_name);
+    if (!found)
+        return false;
+    // renaming updates the index, so walk a copy
+    std::vector<SymbolIndex::Entry> entries = *found;
     bool res = false;
-    for (auto &object : getObjects()) {
-        if (ArchiveObjectFileType::ELF_OBJECT != object->type)
-            continue;
-        std::shared_ptr<ObjectFile> objfile = std::dynamic_pointer_cast<ObjectFile>(object);
+    for (auto& entry : entries) {
         // TODO: now we assume that every symbol we modify is global, and there's no local symbols with same name
         // in other objects. This may be not always the case
-        if (auto search = objfile->find_symbol(old_name) && objfile->rename_symbol(old_name, new_name))
+        if (elf_object(entry.member)->rename_symbol(old_name, new_name))
             res = true;
     }
     return res;
 }
 //------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::StaticLibrary::rename_symbols(const ObjectFile::SymbolRenameRule& rule)
+{
+    // patching the index name by name from workers isn't possible, it's dropped and rebuilt on next lookup instead.
+    // hooks installed into members see it gone and do nothing
+    symbols.reset();
+    std::vector<size_t> counts(objects.size());
+    // members are independent, every worker parses (if needed) and renames its own one
+    Parallel::for_each_index(objects.size(), workers, [&](size_t i) {
+        if (auto objfile = elf_object(i))
+            counts[i] = objfile->rename_symbols(rule);
+    });
+    size_t total = 0;
+    for (size_t count : counts)
+        total += count;
+    LOG_DEBUG("%ld symbol(s) renamed", total);
+    return total;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::StaticLibrary::rename_symbols(const std::unordered_map<std::string, std::string>& mapping)
+{
+    std::unordered_map<std::string_view, const std::string*> lookup;
+    for (auto& entry : mapping)
+        lookup.emplace(entry.first, &entry.second);
+    return rename_symbols([&lookup](const Elf32_Sym&, std::string_view name, std::string& new_name) {
+        auto it = lookup.find(name);
+        if (it == lookup.end())
+            return false;
+        new_name = *it->second;
+        return true;
+    });
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::StaticLibrary::prefix_symbols(const std::string& prefix)
+{
+    // names defined by the archive itself, references to anything else (libc, linker symbols) are left alone
+    std::vector<std::vector<std::string>> defined(objects.size());
+    Parallel::for_each_index(objects.size(), workers, [&](size_t i) {
+        if (auto objfile = elf_object(i))
+            defined[i] = objfile->defined_global_symbols();
+    });
+    std::unordered_set<std::string_view> names;
+    for (auto& member : defined)
+        names.insert(member.begin(), member.end());
+    return rename_symbols([&names, &prefix](const Elf32_Sym& symhdr, std::string_view name, std::string& new_name) {
+        // locals can't clash with anything outside their object
+        if (ELF32_ST_BIND(symhdr.st_info) == STB_LOCAL || ELF32_ST_TYPE(symhdr.st_info) == STT_FILE)
+            return false;
+        if (!names.count(name))
+            return false;
+        new_name.reserve(prefix.size() + name.size());
+        new_name.assign(prefix).append(name);
+        return true;
+    });
+}
+//------------------------------------------------------------------------------------------------------------------------------
+size_t ElfMan::StaticLibrary::change_bindings(const BindingChanges& changes)
+{
+    if (changes.empty())
+        return 0;
+    std::vector<size_t> counts(objects.size());
+    // names don't change, so the symbol index stays valid and workers share nothing
+    Parallel::for_each_index(objects.size(), workers, [&](size_t i) {
+        if (auto objfile = elf_object(i))
+            counts[i] = objfile->change_bindings(changes);
+    });
+    size_t total = 0;
+    for (size_t count : counts)
+        total += count;
+    LOG_DEBUG("binding or visibility of %ld symbol(s) changed", total);
+    return total;
+}
+//------------------------------------------------------------------------------------------------------------------------------
 void ElfMan::StaticLibrary::reorder_symtab_and_relocations()
 {
-    for (auto &obj : getObjects())
-        if (ElfMan::ArchiveObjectFileType::ELF_OBJECT == obj->type)
-            std::dynamic_pointer_cast<ElfMan::ObjectFile>(obj)->reorder_symtab_and_relocations();
+    // only members with rebound symbols have anything to move, unparsed ones can't have any and stay unparsed
+    for (auto& object : objects)
+        if (ArchiveObjectFileType::ELF_OBJECT == object->type)
+            std::static_pointer_cast<ObjectFile>(object)->reorder_changed_symbols();
 }
 //------------------------------------------------------------------------------------------------------------------------------
@@ -12,28 +12,120 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <unordered_map>
 //------------------------------------------------------------------------------------------------------------------------------
 #include "object_file.h"
+#include "mapped_file.h"
+#include "symbol_index.h"
 //------------------------------------------------------------------------------------------------------------------------------
 namespace ElfMan
 {
 //------------------------------------------------------------------------------------------------------------------------------
+enum class ParseMode {
+    EAGER,  // every member is parsed while loading
+    LAZY,   // only ar headers are indexed, members are parsed on first access through get_object()
+    PARALLEL, // every member is parsed while loading, on a pool of worker threads
+};
+//------------------------------------------------------------------------------------------------------------------------------
 class StaticLibrary {
 public:
-    explicit StaticLibrary(const std::vector<uint8_t>& data);
+    // bytes to overwrite at a given position of the archive file
+    struct Patch {
+        size_t offset;
+        std::vector<uint8_t> bytes;
+    };
 
-    // Returns parsed object files
+    // workers is the thread count for PARALLEL mode, 0 means one per core
+    explicit StaticLibrary(const std::vector<uint8_t>& data, ParseMode mode = ParseMode::EAGER, unsigned workers = 0);
+    // takes the buffer over, sections then reference it the same way they do with a mapping
+    explicit StaticLibrary(std::vector<uint8_t>&& data, ParseMode mode = ParseMode::EAGER, unsigned workers = 0);
+    // zero-copy load: members and their sections reference the mapping, which is kept alive by parsed objects
+    explicit StaticLibrary(std::shared_ptr<const MappedFile> file, ParseMode mode = ParseMode::EAGER, unsigned workers = 0);
+
+    // Returns archive members as they are now, in LAZY mode some of them may still be UNPARSED
     const std::vector<std::shared_ptr<ArchiveObjectFile>>& getObjects() const { return objects; }
+    // Returns member by index, parsing it first if needed
+    std::shared_ptr<ArchiveObjectFile> get_object(size_t index);
+    // Returns first ELF member with given filename, parsing it first if needed
+    std::shared_ptr<ObjectFile> get_object(const std::string& filename);
     std::vector<uint8_t> serialize();
+    // exact archive size, also brings member sizes in ar headers up to date
+    size_t serialized_size();
+    void serialize_into(Memory::OutputMemoryStream& stream);
+    // modified members get their string tables merged when written (see ObjectFile::merge_string_tables()).
+    // That usually changes their size, so patch_file() won't apply then
+    void merge_strings_on_write(bool enable = true);
+    // reorders symbol tables of members where bindings were changed through Symbol setters, others aren't touched
     void reorder_symtab_and_relocations();
     // Debug dump of archive contents
     void dump();
-    std::shared_ptr<ElfMan::Symbol> find_symbol(std::string sym_name);
+    // symbol lookups go through an archive wide hash index, built on first use (every member gets parsed then)
+    // and kept current across rename_symbol() and insert_undefined_global_function() on member objects
+    ElfMan::Symbol find_symbol(std::string sym_name);
+    // same as find_symbol(), but skips undefined references.
+    // While no member is modified and the index isn't built yet, it's answered from the archive symbol map instead,
+    // parsing only the member that defines the symbol. The map only lists global definitions, so with global_only
+    // a name it doesn't have is not found without parsing anything, otherwise local ones are looked up in the index
+    ElfMan::Symbol find_definition(std::string sym_name, bool global_only = false);
+    // member defining the symbol according to the archive symbol map, nullptr if there's no map or no such symbol
+    std::shared_ptr<ObjectFile> find_defining_object(const std::string& sym_name);
+    const SymbolIndex& symbol_index();
     bool rename_symbol(std::string old_name, std::string new_name);
+    // Bulk renames. Every member gets parsed and renamed in one pass over its symbol table, on the worker pool,
+    // so the rule has to be safe to call concurrently. The symbol index is rebuilt on next use.
+    // Return the number of renamed symbols over all members
+    size_t rename_symbols(const ObjectFile::SymbolRenameRule& rule);
+    // objcopy --redefine-syms: every symbol named in the mapping, defined or not, local or not
+    size_t rename_symbols(const std::unordered_map<std::string, std::string>& mapping);
+    // objcopy --prefix-symbols, limited to global and weak symbols defined by some member of the archive.
+    // Both definitions and references to them get the prefix, references to anything else keep their names
+    size_t prefix_symbols(const std::string& prefix);
+    // binding and visibility edits over every member, on the worker pool (see BindingChanges).
+    // Every member is classified in one pass and reordered once. Returns the number of changed symbols
+    size_t change_bindings(const BindingChanges& changes);
+    // In-place commit for size-preserving edits (rename_symbol, set_global + reorder, move_relocations...).
+    // Compares every modified member with its original bytes and returns the differing ranges.
+    // Returns false if that's not possible: the library wasn't loaded from a shared image,
+    // or some member changed its size (then the archive has to be rewritten with serialize())
+    bool collect_patches(std::vector<Patch>& patches);
+    // writes collected patches into the archive file with pwrite, the file must be the one the library was loaded from.
+    // nothing is written when collect_patches() fails
+    bool patch_file(const std::string& path);
+    // GNU symbol map ("/" member) payload listing names[i] at member header offset offsets[i], padded to an even size
+    static std::vector<uint8_t> build_symbol_map(const std::vector<std::vector<std::string>>& names,
+                                                 const std::vector<size_t>& offsets);
+    static size_t symbol_map_size(const std::vector<std::vector<std::string>>& names);
 private:
+    void parse(const uint8_t* buffer, size_t total_sz, std::shared_ptr<const void> source, ParseMode mode);
+    // GNU symbol map ("/" member) as (member header offset, symbol name) pairs, false if it's malformed
+    static bool parse_symbol_map(const uint8_t* buffer, size_t size, std::vector<std::pair<uint32_t, std::string>>& entries);
+    // regenerates "/" member from live symbol tables, member sizes in ar headers must be current
+    void rebuild_symbol_map();
+    // name -> member index lookup over the "/" member, built on first use
+    const std::unordered_map<std::string, size_t>& symbol_map_lookup();
+    std::shared_ptr<ObjectFile> elf_object(size_t index);
+
     std::vector<std::shared_ptr<ArchiveObjectFile>> objects;
+    // where every member's ar header was found in the source image and its payload size at that time
+    std::vector<size_t> member_offsets;
+    std::vector<size_t> member_sizes;
+    // member header offsets the current "/" member refers to, updated every time it's rebuilt
+    std::vector<size_t> symbol_map_offsets;
+    // source image, only kept when it has an owner (mapping or vector we took over)
+    std::shared_ptr<const void> image;
+    const uint8_t* image_data = nullptr;
+    size_t image_size = 0;
     std::string nameTable; // GNU string table for long filenames
     std::string symbolTable; // GNU string table for symbols
+    unsigned workers = 0;
+    // shared with the update hooks installed into member objects
+    std::shared_ptr<SymbolIndex> symbols;
+    std::unordered_map<std::string, size_t> symbol_map_members;
+    bool symbol_map_parsed = false;
+    bool merge_strings = false;
+    // raised by ELF members as soon as one of them is modified (see ArchiveObjectFile::modified_flag),
+    // cleared when the symbol map is rebuilt from them
+    std::shared_ptr<std::atomic<bool>> members_modified = std::make_shared<std::atomic<bool>>(false);
 };
 //------------------------------------------------------------------------------------------------------------------------------
 } //namespace ElfMan
@@ -0,0 +1,53 @@
+/*
+ * Auto-added header
+ * File: string_table_builder.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <algorithm>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "string_table_builder.h"
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::StringTableBuilder::finalize()
+{
+	std::vector<std::string_view> strings;
+	strings.reserve(offsets.size());
+	size_t total = 1;
+	for (auto& entry : offsets) {
+		strings.push_back(entry.first);
+		total += entry.first.size() + 1;
+	}
+	// descending order of reversed strings puts every string right after the ones ending with it
+	std::sort(strings.begin(), strings.end(), [](std::string_view a, std::string_view b) {
+		return std::lexicographical_compare(b.rbegin(), b.rend(), a.rbegin(), a.rend());
+	});
+	table.clear();
+	table.reserve(total);
+	table.push_back(0);
+	std::string_view stored;
+	uint32_t stored_at = 0;
+	for (std::string_view str : strings) {
+		uint32_t offset = 0;
+		if (str.empty())
+			offset = 0;
+		else if (stored.size() >= str.size() && stored.compare(stored.size() - str.size(), str.size(), str) == 0)
+			offset = stored_at + stored.size() - str.size();
+		else {
+			stored = str;
+			stored_at = table.size();
+			table.insert(table.end(), str.begin(), str.end());
+			table.push_back(0);
+			offset = stored_at;
+		}
+		offsets[str] = offset;
+	}
+}
+//------------------------------------------------------------------------------------------------------------------------------
+uint32_t ElfMan::StringTableBuilder::offset_of(std::string_view str) const
+{
+	auto it = offsets.find(str);
+	return it != offsets.end() ? it->second : 0;
+}
+//------------------------------------------------------------------------------------------------------------------------------
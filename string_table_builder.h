@@ -0,0 +1,39 @@
+/*
+ * Auto-added header
+ * File: string_table_builder.h
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#ifndef ELFMAN_STRING_TABLE_BUILDER_H
+#define ELFMAN_STRING_TABLE_BUILDER_H
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+//------------------------------------------------------------------------------------------------------------------------------
+namespace ElfMan
+{
+//------------------------------------------------------------------------------------------------------------------------------
+// Builds SHT_STRTAB payload the way linkers do: every string is stored once, and a string which is the tail
+// of a longer one ("bar" of "foobar") is not stored at all, it points into the longer one.
+// Added strings are only referenced, they have to stay alive until finalize()
+class StringTableBuilder {
+public:
+	void add(std::string_view str) { offsets.emplace(str, 0); }
+	// lays the table out, nothing can be added after that
+	void finalize();
+	// offset of an added string, valid after finalize(). Empty string is always at 0
+	uint32_t offset_of(std::string_view str) const;
+	size_t size() const { return table.size(); }
+	std::vector<uint8_t>& data() { return table; }
+private:
+	std::unordered_map<std::string_view, uint32_t> offsets;
+	std::vector<uint8_t> table;
+};
+//------------------------------------------------------------------------------------------------------------------------------
+} //namespace ElfMan
+//------------------------------------------------------------------------------------------------------------------------------
+#endif /*ELFMAN_STRING_TABLE_BUILDER_H*/
@@ -9,22 +9,30 @@
 #include <cstring>
 #include "symbol.h"
 #include "object_file.h"
+#include "symbol_section.h"
+#include "logger.h"
 //------------------------------------------------------------------------------------------------------------------------------
-ElfMan::Symbol::Symbol(Elf32_Sym* sym, ElfMan::ObjectFile* obj)
+Elf32_Sym& ElfMan::Symbol::header() const
 {
-	memcpy(&symhdr,sym,sizeof(symhdr));
-	object = obj;
+	return table->entries[table->index_of(id)];
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::vector<uint8_t> ElfMan::Symbol::serialize()
+uint32_t ElfMan::Symbol::index() const
 {
-	return data;
+	return table->index_of(id);
 }
 //------------------------------------------------------------------------------------------------------------------------------
-std::string ElfMan::Symbol::name()
+ElfMan::ObjectFile* ElfMan::Symbol::object() const
 {
+	return table ? table->object_file() : nullptr;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::string ElfMan::Symbol::name() const
+{
+	ObjectFile* object = this->object();
 	if(!object)
 		return "*error1*";
+	const Elf32_Sym& symhdr = header();
 	std::shared_ptr<RawSection> strtab;
 	if (ELF32_ST_TYPE(symhdr.st_info) == STT_SECTION)
 	{
@@ -35,32 +43,240 @@ std::string ElfMan::Symbol::name()
 			LOG_DEBUG("undefinded section header string table");
 			exit(-1);
 		}
-		LOG_DEBUG("section size = %ld", strtab->data.size());
+		LOG_DEBUG("section size = %ld", strtab->payload_size());
 		int sec_name_index = object->sections_by_index[symhdr.st_shndx]->name_index();
 		LOG_DEBUG("section name index = %d", sec_name_index);
-		return std::string((char*)&strtab->data.data()[sec_name_index]);
+		return std::string((char*)&strtab->bytes()[sec_name_index]);
 	}
 	strtab = object->symbol_strtab_section;
 	if(!strtab)
 		return "*error2*";
-	if (symhdr.st_name >= strtab->size())
+	if (symhdr.st_name >= strtab->payload_size())
 		return "*error3*";
-	LOG_DEBUG("getting name %s", (char*)&strtab->data.data()[symhdr.st_name]);
-	return std::string((char*)&strtab->data.data()[symhdr.st_name]);
+	LOG_DEBUG("getting name %s", (char*)&strtab->bytes()[symhdr.st_name]);
+	return std::string((char*)&strtab->bytes()[symhdr.st_name]);
 }//------------------------------------------------------------------------------------------------------------------------------
-uint32_t ElfMan::Symbol::offset()
+uint32_t ElfMan::Symbol::offset() const
 {
-	return symhdr.st_value;
+	return header().st_value;
 }
 //------------------------------------------------------------------------------------------------------------------------------
-int ElfMan::Symbol::bind()
+int ElfMan::Symbol::bind() const
 {
-	return ELF32_ST_BIND(symhdr.st_info);
+	return ELF32_ST_BIND(header().st_info);
 }
 //------------------------------------------------------------------------------------------------------------------------------
-bool ElfMan::Symbol::set_global()
+bool ElfMan::Symbol::defined() const
 {
-	symhdr.st_info = ELF32_ST_INFO(STB_GLOBAL,ELF32_ST_TYPE(symhdr.st_info));
+	return header().st_shndx != SHN_UNDEF;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+bool ElfMan::Symbol::set_bind(int bind) const
+{
+	if (this->bind() == bind)
+		return true;
+	// undefined symbol has to be resolved by some other object, it can't be local to this one
+	if (bind == STB_LOCAL && !defined())
+		return false;
+	Elf32_Sym& symhdr = header();
+	symhdr.st_info = ELF32_ST_INFO(bind,ELF32_ST_TYPE(symhdr.st_info));
+	table->binding_changed(id);
 	return true;
 }
-//------------------------------------------------------------------------------------------------------------------------------
\ No newline at end of file
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::Symbol::set_visibility(unsigned char visibility) const
+{
+	Elf32_Sym& symhdr = header();
+	if (ELF32_ST_VISIBILITY(symhdr.st_other) == visibility)
+		return;
+	symhdr.st_other = (symhdr.st_other & ~0x3) | ELF32_ST_VISIBILITY(visibility);
+	table->mark_dirty();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::Symbol ElfMan::SymbolSection::append(const Elf32_Sym& symhdr)
+{
+	uint32_t id = indices.size();
+	indices.push_back(entries.size());
+	ids.push_back(id);
+	entries.push_back(symhdr);
+	mark_dirty();
+	return Symbol(this, id);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolSection::permute(const std::vector<uint32_t>& permutation)
+{
+	for (uint32_t i = 0; i < permutation.size(); i++)
+		if (permutation[i] != i) {
+			permute_range(0, permutation);
+			return;
+		}
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolSection::permute_range(uint32_t first, const std::vector<uint32_t>& moved_to)
+{
+	// scratch copies live on the heap, replacing the arrays in the object arena would only leave dead blocks there
+	std::vector<Elf32_Sym> reordered(moved_to.size());
+	std::vector<uint32_t> reordered_ids(moved_to.size());
+	for (uint32_t i = 0; i < moved_to.size(); i++)
+	{
+		uint32_t to = moved_to[i] - first;
+		reordered[to] = entries[first + i];
+		reordered_ids[to] = ids[first + i];
+		indices[ids[first + i]] = moved_to[i];
+	}
+	std::copy(reordered.begin(), reordered.end(), entries.begin() + first);
+	std::copy(reordered_ids.begin(), reordered_ids.end(), ids.begin() + first);
+	mark_dirty();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+namespace
+{
+// FNV-1a over a NUL terminated name, stops at limit. len receives the name length
+uint32_t hash_name(const char* name, size_t limit, size_t& len)
+{
+	uint32_t hash = 2166136261u;
+	for (len = 0; len < limit && name[len]; len++)
+		hash = (hash ^ (uint8_t)name[len]) * 16777619u;
+	return hash;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+uint32_t hash_name(std::string_view name)
+{
+	size_t len;
+	return hash_name(name.data(), name.size(), len);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+bool named_symbol(const Elf32_Sym& symhdr)
+{
+	return symhdr.st_name && ELF32_ST_TYPE(symhdr.st_info) != STT_SECTION;
+}
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::string_view ElfMan::SymbolSection::name_of(uint32_t id) const
+{
+	const Elf32_Sym& symhdr = entries[indices[id]];
+	const std::shared_ptr<RawSection>& strtab = object->symbol_strtab_section;
+	if (!strtab || symhdr.st_name >= strtab->payload_size())
+		return std::string_view();
+	const char* name = (const char*)strtab->bytes() + symhdr.st_name;
+	return std::string_view(name, strnlen(name, strtab->payload_size() - symhdr.st_name));
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolSection::index_names()
+{
+	size_t capacity = 16;
+	while (capacity < entries.size() * 2)
+		capacity <<= 1;
+	name_slots.assign(capacity, NameSlot{0, 0});
+	named = 0;
+	const std::shared_ptr<RawSection>& strtab = object->symbol_strtab_section;
+	if (!strtab)
+		return;
+	const char* names = (const char*)strtab->bytes();
+	size_t names_size = strtab->payload_size();
+	for (uint32_t i = 0; i < entries.size(); i++)
+	{
+		if (!named_symbol(entries[i]) || entries[i].st_name >= names_size)
+			continue;
+		size_t len;
+		uint32_t hash = hash_name(names + entries[i].st_name, names_size - entries[i].st_name, len);
+		if (len)
+			place(hash, ids[i]);
+	}
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolSection::place(uint32_t hash, uint32_t id)
+{
+	if ((named + 1) * 2 > name_slots.size())
+		grow_names();
+	size_t mask = name_slots.size() - 1;
+	std::string_view name = name_of(id);
+	for (size_t i = hash & mask; ; i = (i + 1) & mask)
+	{
+		NameSlot& slot = name_slots[i];
+		if (!slot.id) {
+			slot = NameSlot{hash, id + 1};
+			named++;
+			return;
+		}
+		// first symbol with the name stays
+		if (slot.hash == hash && name_of(slot.id - 1) == name) {
+			slot.shadows = true;
+			return;
+		}
+	}
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolSection::grow_names()
+{
+	std::pmr::vector<NameSlot> old_slots(std::max<size_t>(name_slots.size() * 2, 16), NameSlot{0, 0}, name_slots.get_allocator());
+	old_slots.swap(name_slots);
+	size_t mask = name_slots.size() - 1;
+	// stored hashes are enough to rehash, names aren't touched
+	for (auto& old : old_slots)
+	{
+		if (!old.id)
+			continue;
+		size_t i = old.hash & mask;
+		while (name_slots[i].id)
+			i = (i + 1) & mask;
+		name_slots[i] = old;
+	}
+}
+//------------------------------------------------------------------------------------------------------------------------------
+ElfMan::Symbol ElfMan::SymbolSection::find(std::string_view name) const
+{
+	if (name_slots.empty())
+		return Symbol();
+	uint32_t hash = hash_name(name);
+	size_t mask = name_slots.size() - 1;
+	for (size_t i = hash & mask; name_slots[i].id; i = (i + 1) & mask)
+	{
+		const NameSlot& slot = name_slots[i];
+		if (slot.hash == hash && name_of(slot.id - 1) == name)
+			return Symbol(const_cast<SymbolSection*>(this), slot.id - 1);
+	}
+	return Symbol();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolSection::name_added(Symbol symbol)
+{
+	uint32_t id = symbol.id;
+	if (!named_symbol(entries[indices[id]]))
+		return;
+	std::string_view name = name_of(id);
+	if (!name.empty())
+		place(hash_name(name), id);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolSection::name_removed(Symbol symbol, std::string_view old_name)
+{
+	if (name_slots.empty())
+		return;
+	size_t mask = name_slots.size() - 1;
+	size_t i = hash_name(old_name) & mask;
+	while (name_slots[i].id != symbol.id + 1) {
+		if (!name_slots[i].id)
+			return;
+		i = (i + 1) & mask;
+	}
+	bool shadows = name_slots[i].shadows;
+	// backward shift deletion, entries probed past the freed slot move into it
+	for (size_t j = (i + 1) & mask; name_slots[j].id; j = (j + 1) & mask)
+	{
+		size_t home = name_slots[j].hash & mask;
+		bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+		if (movable) {
+			name_slots[i] = name_slots[j];
+			i = j;
+		}
+	}
+	name_slots[i] = NameSlot{0, 0};
+	named--;
+	// next symbol with the old name takes over, the ones after it are shadowed again
+	if (shadows)
+		for (uint32_t pos = 0; pos < entries.size(); pos++)
+			if (ids[pos] != symbol.id && named_symbol(entries[pos]) && name_of(ids[pos]) == old_name)
+				name_added(Symbol(this, ids[pos]));
+}
+//------------------------------------------------------------------------------------------------------------------------------
@@ -23,20 +23,38 @@ namespace ElfMan
 {
 //------------------------------------------------------------------------------------------------------------------------------
 class ObjectFile;
+class SymbolSection;
 //------------------------------------------------------------------------------------------------------------------------------
+// Handle to a symbol table entry. Entries themselves live in a flat Elf32_Sym array of their SymbolSection,
+// a handle is only the table and a stable id, so it's cheap to copy and keeps pointing to the same entry
+// when the table gets reordered. Default constructed handle is null.
 class Symbol
 {
 public:
-	Symbol(Elf32_Sym* sym, ElfMan::ObjectFile* obj);
-	std::vector<uint8_t> serialize();
-	Elf32_Sym symhdr;
-	std::string name();
-	uint32_t offset();
-	int bind();
-	bool set_global();
-	std::vector<uint8_t> data;
-	int index = 0;
-	ObjectFile* object = nullptr;
+	Symbol() = default;
+	Symbol(SymbolSection* symtab, uint32_t symid) : table(symtab), id(symid) {}
+	explicit operator bool() const { return table != nullptr; }
+	bool operator==(const Symbol& other) const { return table == other.table && id == other.id; }
+	bool operator!=(const Symbol& other) const { return !(*this == other); }
+	Elf32_Sym& header() const;
+	// current position in the symbol table, this is what relocations refer to
+	uint32_t index() const;
+	ObjectFile* object() const;
+	SymbolSection* symtab() const { return table; }
+	std::string name() const;
+	uint32_t offset() const;
+	int bind() const;
+	bool defined() const;
+	bool set_global() const { return set_bind(STB_GLOBAL); }
+	// binding change is recorded for the next reorder_changed_symbols() of the object.
+	// false if it's not possible: undefined symbol can't become local
+	bool set_bind(int bind) const;
+	// STV_* value, binding stays the same
+	void set_visibility(unsigned char visibility) const;
+private:
+	friend class SymbolSection;
+	SymbolSection* table = nullptr;
+	uint32_t id = 0;
 };
 //------------------------------------------------------------------------------------------------------------------------------
 }//namespace ElfMan
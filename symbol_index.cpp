@@ -0,0 +1,71 @@
+/*
+ * Auto-added header
+ * File: symbol_index.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <algorithm>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "symbol_index.h"
+#include "logger.h"
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolIndex::add(size_t member, const Symbol& symbol, const std::string& name)
+{
+	std::vector<Entry>& list = names[name];
+	// members are almost always indexed in order, so this is normally an append
+	auto pos = std::lower_bound(list.begin(), list.end(), member, [](const Entry& entry, size_t m) { return entry.member < m; });
+	if (pos != list.end() && pos->member == member)
+		return;
+	list.insert(pos, Entry{member, symbol});
+}
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolIndex::rename(size_t member, const Symbol& symbol, const std::string& old_name, const std::string& new_name)
+{
+	auto it = names.find(old_name);
+	if (it != names.end()) {
+		std::vector<Entry>& list = it->second;
+		list.erase(std::remove_if(list.begin(), list.end(), [&](const Entry& entry) {
+			return entry.member == member && entry.symbol == symbol;
+		}), list.end());
+		if (list.empty())
+			names.erase(it);
+	}
+	add(member, symbol, new_name);
+}
+//------------------------------------------------------------------------------------------------------------------------------
+const std::vector<ElfMan::SymbolIndex::Entry>* ElfMan::SymbolIndex::entries(const std::string& name) const
+{
+	auto it = names.find(name);
+	if (it == names.end())
+		return nullptr;
+	return &it->second;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+const ElfMan::SymbolIndex::Entry* ElfMan::SymbolIndex::find(const std::string& name) const
+{
+	const std::vector<Entry>* list = entries(name);
+	if (!list || list->empty())
+		return nullptr;
+	return &list->front();
+}
+//------------------------------------------------------------------------------------------------------------------------------
+const ElfMan::SymbolIndex::Entry* ElfMan::SymbolIndex::find_defined(const std::string& name) const
+{
+	if (const std::vector<Entry>* list = entries(name))
+		for (const Entry& entry : *list)
+			if (entry.defined())
+				return &entry;
+	return nullptr;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+const ElfMan::SymbolIndex::Entry* ElfMan::SymbolIndex::find_undefined(const std::string& name) const
+{
+	if (const std::vector<Entry>* list = entries(name))
+		for (const Entry& entry : *list)
+			if (!entry.defined())
+				return &entry;
+	return nullptr;
+}
+//------------------------------------------------------------------------------------------------------------------------------
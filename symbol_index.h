@@ -0,0 +1,51 @@
+/*
+ * Auto-added header
+ * File: symbol_index.h
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#ifndef ELFMAN_SYMBOL_INDEX_H
+#define ELFMAN_SYMBOL_INDEX_H
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "symbol.h"
+//------------------------------------------------------------------------------------------------------------------------------
+namespace ElfMan
+{
+//------------------------------------------------------------------------------------------------------------------------------
+// Archive wide symbol name index.
+// Every name maps to the symbols carrying it, at most one per member (the one ObjectFile::find_symbol returns),
+// ordered by member index, so the first entry is what a linear walk over the archive would find
+class SymbolIndex {
+public:
+	struct Entry {
+		size_t member;
+		Symbol symbol;
+		bool defined() const { return symbol.defined(); }
+	};
+
+	// adds symbol unless its member already has an entry under this name
+	void add(size_t member, const Symbol& symbol, const std::string& name);
+	// moves symbol from old_name to its current name
+	void rename(size_t member, const Symbol& symbol, const std::string& old_name, const std::string& new_name);
+	// first entry in member order, nullptr if there's none
+	const Entry* find(const std::string& name) const;
+	const Entry* find_defined(const std::string& name) const;
+	const Entry* find_undefined(const std::string& name) const;
+	// all entries for the name, in member order
+	const std::vector<Entry>* entries(const std::string& name) const;
+	size_t size() const { return names.size(); }
+private:
+	std::unordered_map<std::string, std::vector<Entry>> names;
+};
+//------------------------------------------------------------------------------------------------------------------------------
+}//namespace ElfMan
+//------------------------------------------------------------------------------------------------------------------------------
+#endif/*ELFMAN_SYMBOL_INDEX_H*/
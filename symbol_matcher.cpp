@@ -0,0 +1,53 @@
+/*
+ * Auto-added header
+ * File: symbol_matcher.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <fstream>
+#include <sstream>
+#include <fnmatch.h>
+//------------------------------------------------------------------------------------------------------------------------------
+#include "symbol_matcher.h"
+#include "logger.h"
+//------------------------------------------------------------------------------------------------------------------------------
+void ElfMan::SymbolMatcher::add(const std::string& pattern)
+{
+	if (pattern.find_first_of("*?[") != std::string::npos)
+		patterns.push_back(pattern);
+	else
+		names.insert(storage.emplace_back(pattern));
+}
+//------------------------------------------------------------------------------------------------------------------------------
+bool ElfMan::SymbolMatcher::add_file(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file) {
+		LOG_ERROR("can't open symbol list: %s", path.c_str());
+		return false;
+	}
+	for (std::string line; std::getline(file, line); ) {
+		std::istringstream stream(line);
+		std::string pattern;
+		if (stream >> pattern && pattern[0] != '#')
+			add(pattern);
+	}
+	return true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+bool ElfMan::SymbolMatcher::matches(std::string_view name) const
+{
+	if (names.count(name))
+		return true;
+	if (patterns.empty())
+		return false;
+	// fnmatch needs a terminated string
+	std::string terminated(name);
+	for (auto& pattern : patterns)
+		if (!fnmatch(pattern.c_str(), terminated.c_str(), 0))
+			return true;
+	return false;
+}
+//------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,49 @@
+/*
+ * Auto-added header
+ * File: symbol_matcher.h
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#ifndef ELFMAN_SYMBOL_MATCHER_H
+#define ELFMAN_SYMBOL_MATCHER_H
+//------------------------------------------------------------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+//------------------------------------------------------------------------------------------------------------------------------
+namespace ElfMan
+{
+//------------------------------------------------------------------------------------------------------------------------------
+// Set of symbol names and shell wildcard patterns (*, ?, [...], as fnmatch takes them).
+// Plain names are hashed, so a long list of them costs one lookup per symbol; only patterns are tried one by one
+class SymbolMatcher {
+public:
+	void add(const std::string& pattern);
+	// one name or pattern per line, empty lines and lines starting with # are skipped. False if it can't be read
+	bool add_file(const std::string& path);
+	bool matches(std::string_view name) const;
+	bool empty() const { return names.empty() && patterns.empty(); }
+private:
+	std::deque<std::string> storage; // owns the strings names point to
+	std::unordered_set<std::string_view> names;
+	std::vector<std::string> patterns;
+};
+//------------------------------------------------------------------------------------------------------------------------------
+// Bulk binding and visibility edits, as objcopy --localize-symbols, --globalize-symbols and --weaken-symbols do,
+// plus hiding (STV_HIDDEN). When a symbol matches several binding lists the later one wins, except that
+// weakening only applies to symbols which are not local by then. Undefined symbols are never localized
+struct BindingChanges {
+	SymbolMatcher localize;
+	SymbolMatcher globalize;
+	SymbolMatcher weaken;
+	SymbolMatcher hide;
+	bool empty() const { return localize.empty() && globalize.empty() && weaken.empty() && hide.empty(); }
+};
+//------------------------------------------------------------------------------------------------------------------------------
+} //namespace ElfMan
+//------------------------------------------------------------------------------------------------------------------------------
+#endif /*ELFMAN_SYMBOL_MATCHER_H*/
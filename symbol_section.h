@@ -15,10 +15,14 @@
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <string_view>
+#include <numeric>
+#include <cstring>
 #include <elf.h>
 //------------------------------------------------------------------------------------------------------------------------------
 #include "section.h"
 #include "symbol.h"
+#include "logger.h"
 #include "memory_helpers.h"
 //------------------------------------------------------------------------------------------------------------------------------
 namespace ElfMan
@@ -29,27 +33,67 @@ public:
     SymbolSection(Elf32_Shdr* header, const uint8_t* buffer, uint32_t total_sz, ObjectFile* obj)
         : Section(header, obj)
     {
-        ElfMan::Memory::InputMemoryStream stream(buffer, total_sz);
-        int index = 0;
-        while (stream.size()) {
-            Elf32_Sym symhdr;
-            stream.read(symhdr);
-            auto symbol = std::make_shared<ElfMan::Symbol>(&symhdr, obj);
-            symbols.push_back(symbol);
-            symbol->index = index++;
+        if (total_sz % sizeof(Elf32_Sym)) {
+            LOG_ERROR("symbol table size %u is not a multiple of %ld", total_sz, sizeof(Elf32_Sym));
+            throw malformed_object("Truncated symbol table");
         }
+        // one copy of the whole table, no per-symbol objects
+        entries.resize(total_sz / sizeof(Elf32_Sym));
+        memcpy(entries.data(), buffer, entries.size() * sizeof(Elf32_Sym));
+        ids.resize(entries.size());
+        std::iota(ids.begin(), ids.end(), 0);
+        indices.assign(ids.begin(), ids.end());
     }
-    virtual std::vector<uint8_t> serialize() {
-        std::vector<uint8_t> result;
-        for (auto sym : symbols)
-        {
-            result.insert(result.end(), (char*)&sym->symhdr, (char*)&sym->symhdr+sizeof(sym->symhdr));
-        }
-        return result;
+    virtual uint32_t serialized_size() { return entries.size() * sizeof(Elf32_Sym); }
+    virtual void serialize_into(Memory::OutputMemoryStream& stream) {
+        stream.write((const uint8_t*)entries.data(), entries.size() * sizeof(Elf32_Sym));
+    }
+    uint32_t count() const { return entries.size(); }
+    // handle of the entry at given position
+    Symbol at(uint32_t index) { return Symbol(this, ids[index]); }
+    uint32_t index_of(uint32_t id) const { return indices[id]; }
+    uint32_t id_of(uint32_t index) const { return ids[index]; }
+    // adds an entry to the end of the table
+    Symbol append(const Elf32_Sym& symhdr);
+    // moves entry at position i to permutation[i], handles follow their entries
+    void permute(const std::vector<uint32_t>& permutation);
+    // same for a part of the table: entry first + i moves to moved_to[i], which stays within the part
+    void permute_range(uint32_t first, const std::vector<uint32_t>& moved_to);
+    // symbols whose binding changed since the last reorder, as handle ids. Maintained by Symbol setters
+    void binding_changed(uint32_t id) { rebound.push_back(id); mark_dirty(); }
+    const std::pmr::vector<uint32_t>& rebound_symbols() const { return rebound; }
+    void clear_rebound() { rebound.clear(); }
+    // Name lookup. It's an open addressing hash over names in the symbol string table, nothing is copied out of it.
+    // Section symbols and unnamed ones aren't indexed, of several symbols sharing a name the first one is found
+    Symbol find(std::string_view name) const;
+    // builds the lookup in one pass over all names, symbol string table has to be known to the object by then
+    void index_names();
+    // keeps the lookup in sync when a symbol was appended or its name was changed in the string table
+    void name_added(Symbol symbol);
+    void name_removed(Symbol symbol, std::string_view old_name);
+    size_t named_count() const { return named; }
+    template <typename Func>
+    void for_each_name(Func func) {
+        for (auto& slot : name_slots)
+            if (slot.id)
+                func(name_of(slot.id - 1), Symbol(this, slot.id - 1));
     }
-    std::vector<std::shared_ptr<ElfMan::Symbol>> symbols;
-    std::map<std::string, std::shared_ptr<ElfMan::Symbol>> symbols_by_name;
+    // raw symbol table, in file order
+    std::pmr::vector<Elf32_Sym> entries{memory()};
 private:
+    struct NameSlot {
+        uint32_t hash;
+        uint32_t id; // handle id + 1, 0 marks a free slot
+        bool shadows = false; // other symbols have the same name
+    };
+    std::string_view name_of(uint32_t id) const;
+    void place(uint32_t hash, uint32_t id);
+    void grow_names();
+    std::pmr::vector<uint32_t> ids{memory()};     // position -> handle id
+    std::pmr::vector<uint32_t> indices{memory()}; // handle id -> position
+    std::pmr::vector<NameSlot> name_slots{memory()};
+    std::pmr::vector<uint32_t> rebound{memory()};
+    size_t named = 0;
     static bool registered;
 };
 //------------------------------------------------------------------------------------------------------------------------------
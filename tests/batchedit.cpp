@@ -0,0 +1,171 @@
+/*
+ * Auto-added header
+ * File: tests/batchedit.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <filesystem>
+#include <getopt.h>   // getopt_long
+//------------------------------------------------------------------------------------------------------------------------------
+#include "object_file.h"
+#include "static_library.h"
+#include "edit_transaction.h"
+#include "logger.h"
+#include "fileops.h"
+//------------------------------------------------------------------------------------------------------------------------------
+/*
+*	This file is a test program which purpose is to apply a whole list of symbol edits to a static library ar file
+*   (Elf32 format) in one run. Every line of the edit file is one edit, empty lines and lines starting with # are skipped:
+*       rename  <old_name> <new_name> [object]
+*       global  <symbol> [object]
+*       insert  <object> <symbol> [thumb]
+*       moverel <object> <src_symbol> <dst_symbol>
+*   Edits without an object apply to every object carrying the symbol. Objects are named like in the archive,
+*   the '/' ar puts after short names may be left out (s0.o and s0.o/ are the same member)
+*/
+//------------------------------------------------------------------------------------------------------------------------------
+void print_help(const char* progname) {
+    std::cout << "Usage: " << progname << " -i <file> -e <edits> [ -o <file> ] [ -c ] [ -m ]\n\n"
+              << "Options:\n"
+              << "  -i, --input   <file>   Input filename\n"
+              << "  -o, --output  <file>   Output filename (default: input file)\n"
+              << "  -e, --edits   <file>   Edit list filename\n"
+              << "  -c, --compact          Drop names left unused by renames from string tables\n"
+              << "  -m, --merge-strings    Merge duplicate and tail strings in tables of modified objects\n"
+              << "  -h, --help             Show this help message\n";
+}
+//------------------------------------------------------------------------------------------------------------------------------
+std::vector<std::string> split_words(const std::string& line)
+{
+    std::istringstream stream(line);
+    std::vector<std::string> words;
+    for (std::string word; stream >> word; )
+        words.push_back(word);
+    return words;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+// edits without an object span the whole archive
+bool archive_wide(const std::vector<std::string>& words)
+{
+    return (words.size() == 3 && words[0] == "rename") || (words.size() == 2 && words[0] == "global");
+}
+//------------------------------------------------------------------------------------------------------------------------------
+// queues one line, returns false if it can't be parsed
+bool queue_edit(ElfMan::EditTransaction& transaction, const std::vector<std::string>& words)
+{
+    if (words.empty() || words[0][0] == '#')
+        return true;
+    const std::string& command = words[0];
+    if (command == "rename" && (words.size() == 3 || words.size() == 4))
+        transaction.rename_symbol(words[1], words[2], words.size() == 4 ? words[3] : "");
+    else if (command == "global" && (words.size() == 2 || words.size() == 3))
+        transaction.set_global(words[1], words.size() == 3 ? words[2] : "");
+    else if (command == "insert" && (words.size() == 3 || words.size() == 4))
+        transaction.insert_undefined_global_function(words[2], words.size() == 4 && words[3] == "thumb", words[1]);
+    else if (command == "moverel" && words.size() == 4)
+        transaction.move_relocations(words[2], words[3], words[1]);
+    else
+        return false;
+    return true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+    std::string input_file;
+    std::string output_file;
+    std::string edits_file;
+    bool compact = false;
+    bool merge_strings = false;
+
+    const char* short_opts = "i:o:e:cmh";
+    const option long_opts[] = {
+        {"input",  required_argument, nullptr, 'i'},
+        {"output", required_argument, nullptr, 'o'},
+        {"edits",  required_argument, nullptr, 'e'},
+        {"compact", no_argument,      nullptr, 'c'},
+        {"merge-strings", no_argument, nullptr, 'm'},
+        {"help",   no_argument,       nullptr, 'h'},
+        {nullptr,  0,                 nullptr,  0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, short_opts, long_opts, nullptr)) != -1) {
+        switch (opt) {
+            case 'i': input_file  = optarg; break;
+            case 'o': output_file = optarg; break;
+            case 'e': edits_file  = optarg; break;
+            case 'c': compact = true; break;
+            case 'm': merge_strings = true; break;
+            case 'h': print_help(argv[0]); return 0;
+            default:
+                print_help(argv[0]);
+                return -1;
+        }
+    }
+
+    if (input_file.empty() || edits_file.empty()) {
+        LOG_ERROR("Both input file (-i) and edit list (-e) must be specified");
+        print_help(argv[0]);
+        return -1;
+    }
+
+    if (output_file.empty())
+        output_file = input_file;
+
+    if (!std::filesystem::exists(input_file)) {
+        LOG_ERROR("file not found: %s", input_file.c_str());
+        return -1;
+    }
+
+    std::ifstream edits(edits_file);
+    if (!edits) {
+        LOG_ERROR("can't open edit list: %s", edits_file.c_str());
+        return -1;
+    }
+    std::vector<std::string> lines;
+    std::vector<std::vector<std::string>> words;
+    // edits without an object need the whole archive parsed anyway, otherwise only the named objects are
+    bool wide = false;
+    for (std::string line; std::getline(edits, line); ) {
+        lines.push_back(line);
+        words.push_back(split_words(line));
+        wide |= archive_wide(words.back());
+    }
+
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
+    ElfMan::StaticLibrary staticlib(input_data, wide ? ElfMan::ParseMode::PARALLEL : ElfMan::ParseMode::LAZY);
+    staticlib.dump();
+    staticlib.merge_strings_on_write(merge_strings);
+
+    ElfMan::EditTransaction transaction(staticlib);
+    transaction.compact_strings(compact);
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (!queue_edit(transaction, words[i])) {
+            LOG_ERROR("%s:%ld: can't parse edit: %s", edits_file.c_str(), i + 1, lines[i].c_str());
+            return -1;
+        }
+    }
+    LOG_INFO("applying %ld edit(s)", transaction.size());
+    if (!transaction.commit())
+        LOG_ERROR("some edits were not applied");
+
+    // when every member kept its size (binding changes, renames written in place, no compaction or merging)
+    // only the touched bytes are patched, otherwise patch_file() refuses and the whole archive is rewritten
+    if (output_file == input_file && staticlib.patch_file(output_file))
+        return 0;
+    std::vector<uint8_t> output_data = staticlib.serialize();
+    if (!Utils::FileOps::write_file(output_file, output_data)) {
+        return -1;
+    }
+    return 0;
+}
+//------------------------------------------------------------------------------------------------------------------------------
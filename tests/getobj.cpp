@@ -80,17 +80,10 @@ int main(int argc, char **argv)
         return -1;
     }
 
-    std::ifstream InputStream(input_file, std::ios::binary);
-    if (!InputStream.is_open()) {
-        LOG_ERROR("cannot open file: %s\n", input_file.c_str());
-        return -1;
-    }
-
-    std::vector<uint8_t> StaticLib(std::filesystem::file_size(input_file));
-    InputStream.read((char*)StaticLib.data(), StaticLib.size());
-    InputStream.close();
+    auto StaticLib = std::make_shared<ElfMan::MappedFile>(input_file);
     std::vector<uint8_t> output_data;
-    ElfMan::StaticLibrary staticlib(StaticLib);
+    // member is extracted from its original bytes, nothing has to be parsed
+    ElfMan::StaticLibrary staticlib(StaticLib, ElfMan::ParseMode::LAZY);
     staticlib.dump();
     for (auto &object : staticlib.getObjects()) {
     	if (object->filename() == output_file) {
@@ -85,19 +85,21 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    std::ifstream InputStream(input_file, std::ios::binary);
-    std::vector<uint8_t> input_data(std::filesystem::file_size(input_file));
-    InputStream.read(reinterpret_cast<char*>(input_data.data()), input_data.size());
-    InputStream.close();
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
 
-    ElfMan::StaticLibrary staticlib(input_data);
+    // only the object we modify needs to be parsed, the rest is written back as is
+    ElfMan::StaticLibrary staticlib(input_data, ElfMan::ParseMode::LAZY);
     staticlib.dump();
     LOG_INFO("inserting symbol %s", symbol_name.c_str());
-    for (auto &object : staticlib.getObjects()) {
-    	if (ElfMan::ArchiveObjectFileType::ELF_OBJECT != object->type || object->filename() != object_name)
-    		continue;
-    	std::shared_ptr<ElfMan::ObjectFile> elfobj = std::dynamic_pointer_cast<ElfMan::ObjectFile>(object);
-    	std::shared_ptr<ElfMan::Symbol> wr_sym = elfobj->insert_undefined_global_function(symbol_name, true);
+    std::shared_ptr<ElfMan::ObjectFile> elfobj = staticlib.get_object(object_name);
+    if (!elfobj) {
+        LOG_ERROR("Object not found: %s", object_name.c_str());
+        return -1;
+    }
+    ElfMan::Symbol wr_sym = elfobj->insert_undefined_global_function(symbol_name, true);
+    if (!wr_sym) {
+        LOG_ERROR("failed to insert symbol %s", symbol_name.c_str());
+        return -1;
     }
 
     std::vector<uint8_t> output_data = staticlib.serialize();
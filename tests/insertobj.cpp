@@ -21,6 +21,7 @@
 #include <getopt.h>   // getopt_long
 //------------------------------------------------------------------------------------------------------------------------------
 #include "object_file.h"
+#include "mapped_file.h"
 #include "static_library.h"
 #include "symbol.h"
 #include "logger.h"
@@ -82,14 +83,15 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    std::ifstream InputStream(input_file, std::ios::binary);
-    std::vector<uint8_t> input_data(std::filesystem::file_size(input_file));
-    InputStream.read(reinterpret_cast<char*>(input_data.data()), input_data.size());
-    InputStream.close();
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
     struct ar_hdr header;
-    ElfMan::ObjectFile elfobj(input_data.data(), input_data.size(), header, input_file);
+    ElfMan::ObjectFile elfobj(input_data->data(), input_data->size(), header, input_file, input_data);
     LOG_INFO("inserting symbol %s", symbol_name.c_str());
-    std::shared_ptr<ElfMan::Symbol> wr_sym = elfobj.insert_undefined_global_function(symbol_name, true);
+    ElfMan::Symbol wr_sym = elfobj.insert_undefined_global_function(symbol_name, true);
+    if (!wr_sym) {
+        LOG_ERROR("failed to insert symbol %s", symbol_name.c_str());
+        return -1;
+    }
 
     std::vector<uint8_t> output_data = elfobj.serialize();
     if (Utils::FileOps::write_file(output_file, output_data)) {
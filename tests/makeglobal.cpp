@@ -80,30 +80,30 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    std::ifstream InputStream(input_file, std::ios::binary);
-    std::vector<uint8_t> input_data(std::filesystem::file_size(input_file));
-    InputStream.read(reinterpret_cast<char*>(input_data.data()), input_data.size());
-    InputStream.close();
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
 
-    LOG_INFO("initial archive size %d", (int)input_data.size());
+    LOG_INFO("initial archive size %d", (int)input_data->size());
     std::vector<uint8_t> output_data;
 
-    ElfMan::StaticLibrary staticlib(input_data);
+    ElfMan::StaticLibrary staticlib(input_data, ElfMan::ParseMode::PARALLEL);
     staticlib.dump();
 
-    std::shared_ptr<ElfMan::Symbol> symbol = staticlib.find_symbol(symbol_name);
+    ElfMan::Symbol symbol = staticlib.find_symbol(symbol_name);
     if (!symbol) {
         LOG_ERROR("symbol not found: %s", symbol_name.c_str());
         return 0;
     }
-    LOG_INFO("symbol found: %s, object %s, offset %08X", symbol_name.c_str(), symbol->object->filename().c_str(), symbol->offset());
-    if (STB_GLOBAL == symbol->bind())
+    LOG_INFO("symbol found: %s, object %s, offset %08X", symbol_name.c_str(), symbol.object()->filename().c_str(), symbol.offset());
+    if (STB_GLOBAL == symbol.bind())
         LOG_INFO("symbol already global - skip");
     else {
-        LOG_INFO("making symbol global: %s", symbol->name().c_str());
-        symbol->set_global();
+        LOG_INFO("making symbol global: %s", symbol.name().c_str());
+        symbol.set_global();
         staticlib.reorder_symtab_and_relocations();
     }
+    // binding change and symtab reorder keep all sizes, so patch the archive in place when we can
+    if (output_file == input_file && staticlib.patch_file(output_file))
+        return 0;
     output_data = staticlib.serialize();
     LOG_INFO("resulting archive size %d\n", (int)output_data.size());
     if (output_data.size() <= 0) {
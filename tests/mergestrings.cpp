@@ -0,0 +1,119 @@
+/*
+ * Auto-added header
+ * File: tests/mergestrings.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <filesystem>
+#include <getopt.h>   // getopt_long
+//------------------------------------------------------------------------------------------------------------------------------
+#include "object_file.h"
+#include "static_library.h"
+#include "logger.h"
+#include "fileops.h"
+//------------------------------------------------------------------------------------------------------------------------------
+/*
+*	This file is a test program which purpose is to merge string tables of every member of a static library ar file
+*   (Elf32 format), dropping unused strings and sharing tails. It also checks that every member whose tables gave
+*   back more bytes than section alignment can absorb actually got smaller, and fails otherwise
+*/
+//------------------------------------------------------------------------------------------------------------------------------
+void print_help(const char* progname) {
+    std::cout << "Usage: " << progname << " -i <file> [ -o <file> ]\n\n"
+              << "Options:\n"
+              << "  -i, --input   <file>   Input filename\n"
+              << "  -o, --output  <file>   Output filename (default: input file)\n"
+              << "  -h, --help             Show this help message\n";
+}
+//------------------------------------------------------------------------------------------------------------------------------
+// largest alignment layout() may pad to, the section header table is word aligned
+uint32_t largest_alignment(ElfMan::ObjectFile& object)
+{
+    uint32_t alignment = sizeof(uint32_t);
+    for (auto& section : object.sections_by_index)
+        alignment = std::max(alignment, section->addralign());
+    return alignment;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+    std::string input_file;
+    std::string output_file;
+
+    const char* short_opts = "i:o:h";
+    const option long_opts[] = {
+        {"input",  required_argument, nullptr, 'i'},
+        {"output", required_argument, nullptr, 'o'},
+        {"help",   no_argument,       nullptr, 'h'},
+        {nullptr,  0,                 nullptr,  0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, short_opts, long_opts, nullptr)) != -1) {
+        switch (opt) {
+            case 'i': input_file  = optarg; break;
+            case 'o': output_file = optarg; break;
+            case 'h': print_help(argv[0]); return 0;
+            default:
+                print_help(argv[0]);
+                return -1;
+        }
+    }
+
+    if (input_file.empty()) {
+        LOG_ERROR("Input file (-i) must be specified");
+        print_help(argv[0]);
+        return -1;
+    }
+
+    if (output_file.empty())
+        output_file = input_file;
+
+    if (!std::filesystem::exists(input_file)) {
+        LOG_ERROR("file not found: %s", input_file.c_str());
+        return -1;
+    }
+
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
+    ElfMan::StaticLibrary staticlib(input_data, ElfMan::ParseMode::PARALLEL);
+    staticlib.dump();
+
+    size_t total_reclaimed = 0;
+    size_t total_shrunk = 0;
+    bool failed = false;
+    for (auto& member : staticlib.getObjects()) {
+        auto object = std::dynamic_pointer_cast<ElfMan::ObjectFile>(member);
+        if (!object)
+            continue;
+        size_t before = object->serialized_size();
+        size_t reclaimed = object->merge_string_tables();
+        if (!reclaimed)
+            continue;
+        size_t after = object->serialized_size();
+        LOG_INFO("%s: %ld string table byte(s) reclaimed, %ld -> %ld bytes",
+                 object->filename().c_str(), reclaimed, before, after);
+        if (reclaimed >= largest_alignment(*object) && after >= before) {
+            LOG_ERROR("%s: string tables shrank but the object didn't", object->filename().c_str());
+            failed = true;
+        }
+        total_reclaimed += reclaimed;
+        total_shrunk += before > after ? before - after : 0;
+    }
+    LOG_INFO("%ld string table byte(s) reclaimed, objects are %ld byte(s) smaller", total_reclaimed, total_shrunk);
+    if (failed)
+        return -1;
+
+    std::vector<uint8_t> output_data = staticlib.serialize();
+    if (!Utils::FileOps::write_file(output_file, output_data)) {
+        return -1;
+    }
+    return 0;
+}
+//------------------------------------------------------------------------------------------------------------------------------
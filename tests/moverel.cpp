@@ -89,30 +89,28 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    std::ifstream InputStream(input_file, std::ios::binary);
-    std::vector<uint8_t> input_data(std::filesystem::file_size(input_file));
-    InputStream.read(reinterpret_cast<char*>(input_data.data()), input_data.size());
-    InputStream.close();
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
 
-    ElfMan::StaticLibrary staticlib(input_data);
+    // only the object we modify needs to be parsed, the rest is written back as is
+    ElfMan::StaticLibrary staticlib(input_data, ElfMan::ParseMode::LAZY);
     staticlib.dump();
     LOG_INFO("moving relocations from symbol %s to %s", src_name.c_str(), dst_name.c_str());
-    for (auto &object : staticlib.getObjects()) {
-    	if (ElfMan::ArchiveObjectFileType::ELF_OBJECT != object->type || object->filename() != object_name)
-    		continue;
-    	std::shared_ptr<ElfMan::ObjectFile> elfobj = std::dynamic_pointer_cast<ElfMan::ObjectFile>(object);
-        std::shared_ptr<ElfMan::Symbol> src_sym = elfobj->find_symbol(src_name);
-        std::shared_ptr<ElfMan::Symbol> dst_sym = elfobj->find_symbol(dst_name);
-        if (!src_sym) {
-            LOG_ERROR("Symbol not found: %s", src_name.c_str());
-            return -1;
-        }
-        if (!dst_sym) {
-            LOG_ERROR("Symbol not found: %s", dst_name.c_str());
-            return -1;
-        }
-        elfobj->move_relocations(src_sym->index, dst_sym->index);
+    std::shared_ptr<ElfMan::ObjectFile> elfobj = staticlib.get_object(object_name);
+    if (!elfobj) {
+        LOG_ERROR("Object not found: %s", object_name.c_str());
+        return -1;
+    }
+    ElfMan::Symbol src_sym = elfobj->find_symbol(src_name);
+    ElfMan::Symbol dst_sym = elfobj->find_symbol(dst_name);
+    if (!src_sym) {
+        LOG_ERROR("Symbol not found: %s", src_name.c_str());
+        return -1;
+    }
+    if (!dst_sym) {
+        LOG_ERROR("Symbol not found: %s", dst_name.c_str());
+        return -1;
     }
+    elfobj->move_relocations(src_sym.index(), dst_sym.index());
 
     std::vector<uint8_t> output_data = staticlib.serialize();
     if (Utils::FileOps::write_file(output_file, output_data)) {
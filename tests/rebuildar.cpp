@@ -73,14 +73,11 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    std::ifstream InputStream(input_file, std::ios::binary);
-    std::vector<uint8_t> input_data(std::filesystem::file_size(input_file));
-    InputStream.read(reinterpret_cast<char*>(input_data.data()), input_data.size());
-    InputStream.close();
-    LOG_INFO("initial archive size %d", (int)input_data.size());
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
+    LOG_INFO("initial archive size %d", (int)input_data->size());
     std::vector<uint8_t> output_data;
 
-    ElfMan::StaticLibrary staticlib(input_data);
+    ElfMan::StaticLibrary staticlib(input_data, ElfMan::ParseMode::PARALLEL);
     staticlib.dump();
     output_data = staticlib.serialize();
 	LOG_INFO("resulting archive size %d\n", (int)output_data.size());
@@ -21,6 +21,7 @@
 #include <getopt.h>   // getopt_long
 //------------------------------------------------------------------------------------------------------------------------------
 #include "object_file.h"
+#include "mapped_file.h"
 #include "logger.h"
 #include "fileops.h"
 //------------------------------------------------------------------------------------------------------------------------------
@@ -72,15 +73,12 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    std::ifstream InputStream(input_file, std::ios::binary);
-    std::vector<uint8_t> input_data(std::filesystem::file_size(input_file));
-    InputStream.read(reinterpret_cast<char*>(input_data.data()), input_data.size());
-    InputStream.close();
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
 
     std::vector<uint8_t> output_data;
-    LOG_INFO("initial object size %d", (int)input_data.size());
+    LOG_INFO("initial object size %d", (int)input_data->size());
     struct ar_hdr header; // placeholder
-	ElfMan::ObjectFile obj(input_data.data(), input_data.size(), header, input_file);
+	ElfMan::ObjectFile obj(input_data->data(), input_data->size(), header, input_file, input_data);
 	output_data = obj.serialize();
 	LOG_INFO("resulting object size %d\n", (int)output_data.size());
     if (output_data.size() <= 0) {
@@ -85,12 +85,9 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    std::ifstream InputStream(input_file, std::ios::binary);
-    std::vector<uint8_t> input_data(std::filesystem::file_size(input_file));
-    InputStream.read(reinterpret_cast<char*>(input_data.data()), input_data.size());
-    InputStream.close();
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
 
-    ElfMan::StaticLibrary staticlib(input_data);
+    ElfMan::StaticLibrary staticlib(input_data, ElfMan::ParseMode::PARALLEL);
     staticlib.dump();
     LOG_INFO("renaming symbol %s to %s", src_name.c_str(), dst_name.c_str());
     bool result = staticlib.rename_symbol(src_name, dst_name);
@@ -98,6 +95,11 @@ int main(int argc, char** argv) {
         LOG_ERROR("failed to rename symbol %s to %s", src_name.c_str(), dst_name.c_str());
         return -1;
     }
+    // a name that fits over the old one (and doesn't share its bytes with another name) is written in place,
+    // then member sizes stay and only the touched bytes are patched. Longer or shared names are appended to
+    // the string table, the member grows and patch_file() refuses, so the whole archive is rewritten instead
+    if (output_file == input_file && staticlib.patch_file(output_file))
+        return 0;
     std::vector<uint8_t> output_data = staticlib.serialize();
     if (Utils::FileOps::write_file(output_file, output_data)) {
         return -1;
@@ -0,0 +1,137 @@
+/*
+ * Auto-added header
+ * File: tests/renamesyms.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <getopt.h>   // getopt_long
+//------------------------------------------------------------------------------------------------------------------------------
+#include "object_file.h"
+#include "static_library.h"
+#include "logger.h"
+#include "fileops.h"
+//------------------------------------------------------------------------------------------------------------------------------
+/*
+*	This file is a test program which purpose is to rename many symbols of a static library ar file (Elf32 format)
+*   in one run, like objcopy --redefine-syms and --prefix-symbols do. Every line of the mapping file is
+*   "<old_name> <new_name>", empty lines and lines starting with # are skipped.
+*   Prefix is only given to global symbols defined in the archive, and to every reference to them
+*/
+//------------------------------------------------------------------------------------------------------------------------------
+void print_help(const char* progname) {
+    std::cout << "Usage: " << progname << " -i <file> { -f <mapping> | -p <prefix> } [ -o <file> ]\n\n"
+              << "Options:\n"
+              << "  -i, --input   <file>     Input filename\n"
+              << "  -o, --output  <file>     Output filename (default: input file)\n"
+              << "  -f, --mapping <file>     Old to new name mapping filename\n"
+              << "  -p, --prefix  <prefix>   Prefix for global symbols defined in the archive\n"
+              << "  -h, --help               Show this help message\n";
+}
+//------------------------------------------------------------------------------------------------------------------------------
+// returns false if some line can't be parsed
+bool read_mapping(const std::string& path, std::unordered_map<std::string, std::string>& mapping)
+{
+    std::ifstream file(path);
+    if (!file) {
+        LOG_ERROR("can't open mapping: %s", path.c_str());
+        return false;
+    }
+    size_t line_number = 0;
+    for (std::string line; std::getline(file, line); ) {
+        line_number++;
+        std::istringstream stream(line);
+        std::string old_name, new_name, extra;
+        if (!(stream >> old_name) || old_name[0] == '#')
+            continue;
+        if (!(stream >> new_name) || (stream >> extra)) {
+            LOG_ERROR("%s:%ld: can't parse mapping: %s", path.c_str(), line_number, line.c_str());
+            return false;
+        }
+        mapping[old_name] = new_name;
+    }
+    return true;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+    std::string input_file;
+    std::string output_file;
+    std::string mapping_file;
+    std::string prefix;
+
+    const char* short_opts = "i:o:f:p:h";
+    const option long_opts[] = {
+        {"input",   required_argument, nullptr, 'i'},
+        {"output",  required_argument, nullptr, 'o'},
+        {"mapping", required_argument, nullptr, 'f'},
+        {"prefix",  required_argument, nullptr, 'p'},
+        {"help",    no_argument,       nullptr, 'h'},
+        {nullptr,   0,                 nullptr,  0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, short_opts, long_opts, nullptr)) != -1) {
+        switch (opt) {
+            case 'i': input_file   = optarg; break;
+            case 'o': output_file  = optarg; break;
+            case 'f': mapping_file = optarg; break;
+            case 'p': prefix       = optarg; break;
+            case 'h': print_help(argv[0]); return 0;
+            default:
+                print_help(argv[0]);
+                return -1;
+        }
+    }
+
+    if (input_file.empty() || (mapping_file.empty() && prefix.empty())) {
+        LOG_ERROR("Input file (-i) and either a mapping (-f) or a prefix (-p) must be specified");
+        print_help(argv[0]);
+        return -1;
+    }
+
+    if (output_file.empty())
+        output_file = input_file;
+
+    if (!std::filesystem::exists(input_file)) {
+        LOG_ERROR("file not found: %s", input_file.c_str());
+        return -1;
+    }
+
+    std::unordered_map<std::string, std::string> mapping;
+    if (!mapping_file.empty() && !read_mapping(mapping_file, mapping))
+        return -1;
+
+    // every member is renamed, so they are all parsed up front
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
+    ElfMan::StaticLibrary staticlib(input_data, ElfMan::ParseMode::PARALLEL);
+    staticlib.dump();
+
+    size_t renamed = 0;
+    if (!mapping.empty()) {
+        LOG_INFO("renaming %ld symbol name(s) from %s", mapping.size(), mapping_file.c_str());
+        renamed += staticlib.rename_symbols(mapping);
+    }
+    if (!prefix.empty()) {
+        LOG_INFO("adding prefix %s to symbols defined in the archive", prefix.c_str());
+        renamed += staticlib.prefix_symbols(prefix);
+    }
+    LOG_INFO("%ld symbol(s) renamed", renamed);
+
+    std::vector<uint8_t> output_data = staticlib.serialize();
+    if (!Utils::FileOps::write_file(output_file, output_data)) {
+        return -1;
+    }
+    return 0;
+}
+//------------------------------------------------------------------------------------------------------------------------------
@@ -30,10 +30,12 @@
 */
 //------------------------------------------------------------------------------------------------------------------------------
 void print_help(const char* progname) {
-    std::cout << "Usage: " << progname << " -i <file> -s <symbol>\n\n"
+    std::cout << "Usage: " << progname << " -i <file> -s <symbol> [ -g ]\n\n"
               << "Options:\n"
               << "  -i, --input   <file>   Input filename\n"
               << "  -s, --symbol  <symbol> Symbol name\n"
+              << "  -g, --global           Only look for a global definition, names missing from the archive\n"
+              << "                         symbol map are then not found without parsing any member\n"
               << "  -h, --help             Show this help message\n";
 }
 //------------------------------------------------------------------------------------------------------------------------------
@@ -41,11 +43,13 @@ int main(int argc, char** argv) {
     std::string input_file;
     std::string output_file;
     std::string symbol_name;
+    bool global_only = false;
 
-    const char* short_opts = "i:s:h";
+    const char* short_opts = "i:s:gh";
     const option long_opts[] = {
         {"input",  required_argument, nullptr, 'i'},
         {"symbol", required_argument, nullptr, 's'},
+        {"global", no_argument,       nullptr, 'g'},
         {"help",   no_argument,       nullptr, 'h'},
         {nullptr,  0,                 nullptr,  0 }
     };
@@ -55,6 +59,7 @@ int main(int argc, char** argv) {
         switch (opt) {
             case 'i': input_file  = optarg; break;
             case 's': symbol_name = optarg; break;
+            case 'g': global_only = true; break;
             case 'h': print_help(argv[0]); return 0;
             default:
                 print_help(argv[0]);
@@ -73,19 +78,19 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    std::ifstream InputStream(input_file, std::ios::binary);
-    std::vector<uint8_t> input_data(std::filesystem::file_size(input_file));
-    InputStream.read(reinterpret_cast<char*>(input_data.data()), input_data.size());
-    InputStream.close();
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
 
-    ElfMan::StaticLibrary staticlib(input_data);
+    // definitions are resolved through the archive symbol map, so only the defining member gets parsed
+    ElfMan::StaticLibrary staticlib(input_data, ElfMan::ParseMode::LAZY);
     staticlib.dump();
-    std::shared_ptr<ElfMan::Symbol> symbol = staticlib.find_symbol(symbol_name);
+    ElfMan::Symbol symbol = staticlib.find_definition(symbol_name, global_only);
+    if (!symbol && !global_only)
+        symbol = staticlib.find_symbol(symbol_name);
     if (!symbol) {
         LOG_ERROR("symbol not found: %s", symbol_name.c_str());
         return 0;
     }
-    LOG_INFO("symbol found: %s, object %s, offset %08X", symbol_name.c_str(), symbol->object->filename().c_str(), symbol->offset());
+    LOG_INFO("symbol found: %s, object %s, offset %08X", symbol_name.c_str(), symbol.object()->filename().c_str(), symbol.offset());
     return 0;
 }
 //------------------------------------------------------------------------------------------------------------------------------
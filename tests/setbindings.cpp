@@ -0,0 +1,130 @@
+/*
+ * Auto-added header
+ * File: tests/setbindings.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <filesystem>
+#include <getopt.h>   // getopt_long
+//------------------------------------------------------------------------------------------------------------------------------
+#include "object_file.h"
+#include "static_library.h"
+#include "symbol_matcher.h"
+#include "logger.h"
+#include "fileops.h"
+//------------------------------------------------------------------------------------------------------------------------------
+/*
+*	This file is a test program which purpose is to change binding and visibility of many symbols of a static library
+*   ar file (Elf32 format) in one run, like objcopy --localize-symbols, --globalize-symbols and --weaken-symbols do.
+*   Symbols are given one by one on the command line or as list files with one name per line,
+*   both may be shell wildcard patterns
+*/
+//------------------------------------------------------------------------------------------------------------------------------
+void print_help(const char* progname) {
+    std::cout << "Usage: " << progname << " -i <file> [ -o <file> ] [ edits ]\n\n"
+              << "Options:\n"
+              << "  -i, --input   <file>               Input filename\n"
+              << "  -o, --output  <file>               Output filename (default: input file)\n"
+              << "  -L, --localize-symbol  <pattern>   Make matching symbols local\n"
+              << "  -G, --globalize-symbol <pattern>   Make matching symbols global\n"
+              << "  -W, --weaken-symbol    <pattern>   Make matching symbols weak\n"
+              << "  -H, --hide-symbol      <pattern>   Make matching symbols hidden\n"
+              << "      --localize-symbols  <file>     Same, with patterns read from a file\n"
+              << "      --globalize-symbols <file>\n"
+              << "      --weaken-symbols    <file>\n"
+              << "      --hide-symbols      <file>\n"
+              << "  -h, --help                         Show this help message\n";
+}
+//------------------------------------------------------------------------------------------------------------------------------
+// long options without a short form
+enum ListOption {
+    LOCALIZE_LIST = 256,
+    GLOBALIZE_LIST,
+    WEAKEN_LIST,
+    HIDE_LIST,
+};
+//------------------------------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+    std::string input_file;
+    std::string output_file;
+    ElfMan::BindingChanges changes;
+
+    const char* short_opts = "i:o:L:G:W:H:h";
+    const option long_opts[] = {
+        {"input",             required_argument, nullptr, 'i'},
+        {"output",            required_argument, nullptr, 'o'},
+        {"localize-symbol",   required_argument, nullptr, 'L'},
+        {"globalize-symbol",  required_argument, nullptr, 'G'},
+        {"weaken-symbol",     required_argument, nullptr, 'W'},
+        {"hide-symbol",       required_argument, nullptr, 'H'},
+        {"localize-symbols",  required_argument, nullptr, LOCALIZE_LIST},
+        {"globalize-symbols", required_argument, nullptr, GLOBALIZE_LIST},
+        {"weaken-symbols",    required_argument, nullptr, WEAKEN_LIST},
+        {"hide-symbols",      required_argument, nullptr, HIDE_LIST},
+        {"help",              no_argument,       nullptr, 'h'},
+        {nullptr,             0,                 nullptr,  0 }
+    };
+
+    int opt;
+    bool lists_read = true;
+    while ((opt = getopt_long(argc, argv, short_opts, long_opts, nullptr)) != -1) {
+        switch (opt) {
+            case 'i': input_file  = optarg; break;
+            case 'o': output_file = optarg; break;
+            case 'L': changes.localize.add(optarg); break;
+            case 'G': changes.globalize.add(optarg); break;
+            case 'W': changes.weaken.add(optarg); break;
+            case 'H': changes.hide.add(optarg); break;
+            case LOCALIZE_LIST:  lists_read &= changes.localize.add_file(optarg); break;
+            case GLOBALIZE_LIST: lists_read &= changes.globalize.add_file(optarg); break;
+            case WEAKEN_LIST:    lists_read &= changes.weaken.add_file(optarg); break;
+            case HIDE_LIST:      lists_read &= changes.hide.add_file(optarg); break;
+            case 'h': print_help(argv[0]); return 0;
+            default:
+                print_help(argv[0]);
+                return -1;
+        }
+    }
+
+    if (input_file.empty() || changes.empty()) {
+        LOG_ERROR("Input file (-i) and at least one symbol edit must be specified");
+        print_help(argv[0]);
+        return -1;
+    }
+    if (!lists_read)
+        return -1;
+
+    if (output_file.empty())
+        output_file = input_file;
+
+    if (!std::filesystem::exists(input_file)) {
+        LOG_ERROR("file not found: %s", input_file.c_str());
+        return -1;
+    }
+
+    // every member is classified, so they are all parsed up front
+    auto input_data = std::make_shared<ElfMan::MappedFile>(input_file);
+    ElfMan::StaticLibrary staticlib(input_data, ElfMan::ParseMode::PARALLEL);
+    staticlib.dump();
+
+    size_t changed = staticlib.change_bindings(changes);
+    LOG_INFO("binding or visibility of %ld symbol(s) changed", changed);
+
+    // binding changes keep all sizes, then only the touched bytes have to be written back
+    if (output_file == input_file && staticlib.patch_file(output_file))
+        return 0;
+    std::vector<uint8_t> output_data = staticlib.serialize();
+    if (!Utils::FileOps::write_file(output_file, output_data)) {
+        return -1;
+    }
+    return 0;
+}
+//------------------------------------------------------------------------------------------------------------------------------
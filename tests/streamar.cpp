@@ -0,0 +1,117 @@
+/*
+ * Auto-added header
+ * File: tests/streamar.cpp
+ * Author: camradeling
+ * Email: camradeling@gmail.com
+ * 2025
+ */
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <getopt.h>   // getopt_long
+//------------------------------------------------------------------------------------------------------------------------------
+#include "archive_reader.h"
+#include "archive_writer.h"
+#include "logger.h"
+//------------------------------------------------------------------------------------------------------------------------------
+/*
+*	This file is a test program which purpose is to rebuild a static library ar file (Elf32 format) member by member,
+* 	without holding the whole archive in memory. Input and output may be pipes
+*/
+//------------------------------------------------------------------------------------------------------------------------------
+void print_help(const char* progname) {
+    std::cout << "Usage: " << progname << " [ -i <input> ] [ -o <output> ]\n\n"
+              << "Options:\n"
+              << "  -i, --input   <file>   Input filename (default: stdin)\n"
+              << "  -o, --output  <file>   Output filename (default: stdout)\n"
+              << "  -l, --lazy             Don't parse members, copy them as is\n"
+              << "  -h, --help             Show this help message\n";
+}
+//------------------------------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+    std::string input_file;
+    std::string output_file;
+    ElfMan::ParseMode mode = ElfMan::ParseMode::EAGER;
+
+    const char* short_opts = "i:o:lh";
+    const option long_opts[] = {
+        {"input",  required_argument, nullptr, 'i'},
+        {"output", required_argument, nullptr, 'o'},
+        {"lazy",   no_argument,       nullptr, 'l'},
+        {"help",   no_argument,       nullptr, 'h'},
+        {nullptr,  0,                 nullptr,  0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, short_opts, long_opts, nullptr)) != -1) {
+        switch (opt) {
+            case 'i': input_file  = optarg; break;
+            case 'o': output_file = optarg; break;
+            case 'l': mode = ElfMan::ParseMode::LAZY; break;
+            case 'h': print_help(argv[0]); return 0;
+            default:
+                print_help(argv[0]);
+                return -1;
+        }
+    }
+
+    int input_fd = STDIN_FILENO;
+    if (!input_file.empty() && input_file != "-") {
+        input_fd = open(input_file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (input_fd < 0) {
+            LOG_ERROR("failed to open %s: %s", input_file.c_str(), strerror(errno));
+            return -1;
+        }
+    }
+    int output_fd = STDOUT_FILENO;
+    if (!output_file.empty() && output_file != "-") {
+        // not truncated until we know it's not the input
+        output_fd = open(output_file.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (output_fd < 0) {
+            LOG_ERROR("failed to open %s: %s", output_file.c_str(), strerror(errno));
+            return -1;
+        }
+    }
+    // input is read while output is written, the same file would be truncated before it's read
+    struct stat input_stat, output_stat;
+    if (fstat(input_fd, &input_stat) == 0 && fstat(output_fd, &output_stat) == 0 && S_ISREG(input_stat.st_mode)
+        && input_stat.st_dev == output_stat.st_dev && input_stat.st_ino == output_stat.st_ino) {
+        LOG_ERROR("input and output are the same file, write to another one");
+        return -1;
+    }
+    if (output_fd != STDOUT_FILENO && ftruncate(output_fd, 0) < 0) {
+        LOG_ERROR("failed to truncate %s: %s", output_file.c_str(), strerror(errno));
+        return -1;
+    }
+
+    ElfMan::ArchiveReader reader(input_fd, mode);
+    ElfMan::ArchiveWriter writer(output_fd);
+    size_t count = reader.for_each([&](std::shared_ptr<ElfMan::ArchiveObjectFile> member) {
+        writer.add(member);
+        return true;
+    });
+    // symbol map is filled in last, output to a pipe is held back until then
+    try {
+        writer.finish();
+    }
+    catch (const std::exception& e) {
+        LOG_ERROR("failed to write archive symbol map: %s", e.what());
+        return -1;
+    }
+    LOG_INFO("%ld member(s), resulting archive size %ld", count, writer.written());
+
+    if (input_fd != STDIN_FILENO)
+        close(input_fd);
+    if (output_fd != STDOUT_FILENO && close(output_fd) < 0) {
+        LOG_ERROR("failed to write %s: %s", output_file.c_str(), strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+//------------------------------------------------------------------------------------------------------------------------------